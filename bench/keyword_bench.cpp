@@ -0,0 +1,124 @@
+// keyword_bench.cpp
+// Микробенчмарк классификации идентификаторов: совершенный хеш checkKeyword
+// против прежней цепочки сравнений (unordered_set + if (str == "...")).
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "TokenType.h"
+
+namespace {
+
+// Прежняя реализация checkKeyword, оставлена как эталон для сравнения
+TokenType legacyCheckKeyword(std::string_view str) {
+  static const std::unordered_set<std::string_view> keywords = {
+      "function", "var",    "let",   "struct", "exception", "middleware",
+      "endpoint", "apply",  "if",    "elif",   "else",      "return",
+      "match",    "switch", "throw", "for",    "in",        "while",
+      "break",    "continue", "async", "await", "true",     "false",
+      "undefined", "null",  "GET",   "POST",   "PUT",       "DELETE",
+  };
+
+  if (keywords.find(str) != keywords.end()) {
+    if (str == "function") return TokenType::KW_FUNCTION;
+    if (str == "var") return TokenType::KW_VAR;
+    if (str == "let") return TokenType::KW_LET;
+    if (str == "struct") return TokenType::KW_STRUCT;
+    if (str == "exception") return TokenType::KW_EXCEPTION;
+    if (str == "middleware") return TokenType::KW_MIDDLEWARE;
+    if (str == "endpoint") return TokenType::KW_ENDPOINT;
+    if (str == "apply") return TokenType::KW_APPLY;
+    if (str == "if") return TokenType::KW_IF;
+    if (str == "elif") return TokenType::KW_ELIF;
+    if (str == "else") return TokenType::KW_ELSE;
+    if (str == "return") return TokenType::KW_RETURN;
+    if (str == "match") return TokenType::KW_MATCH;
+    if (str == "switch") return TokenType::KW_SWITCH;
+    if (str == "throw") return TokenType::KW_THROW;
+    if (str == "for") return TokenType::KW_FOR;
+    if (str == "in") return TokenType::KW_IN;
+    if (str == "while") return TokenType::KW_WHILE;
+    if (str == "break") return TokenType::KW_BREAK;
+    if (str == "continue") return TokenType::KW_CONTINUE;
+    if (str == "async") return TokenType::KW_ASYNC;
+    if (str == "await") return TokenType::KW_AWAIT;
+    if (str == "true") return TokenType::KW_TRUE;
+    if (str == "false") return TokenType::KW_FALSE;
+    if (str == "undefined") return TokenType::KW_UNDEFINED;
+    if (str == "null") return TokenType::KW_NULL;
+    if (str == "GET") return TokenType::KW_GET;
+    if (str == "POST") return TokenType::KW_POST;
+    if (str == "PUT") return TokenType::KW_PUT;
+    if (str == "DELETE") return TokenType::KW_DELETE;
+  }
+  return TokenType::Identifier;
+}
+
+// Смесь ключевых слов и обычных идентификаторов, как в типичном исходнике
+std::vector<std::string> makeWords(size_t count, unsigned keywordPercent) {
+  static const char* identifiers[] = {
+      "userId", "deleteUserById", "response", "x", "i", "message", "ok",
+      "validateAdmin", "logRequest", "auth", "users", "get", "post", "value",
+      "functional", "lets", "iff", "elsewhere", "nullable", "GETTER",
+  };
+  std::mt19937 rng(42);
+  std::vector<std::string> words;
+  words.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (rng() % 100 < keywordPercent) {
+      words.emplace_back(kKeywords[rng() % std::size(kKeywords)].text);
+    } else {
+      words.emplace_back(identifiers[rng() % std::size(identifiers)]);
+    }
+  }
+  return words;
+}
+
+template <typename Fn>
+double nsPerLookup(const std::vector<std::string>& words, int rounds, Fn fn) {
+  unsigned sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (const auto& w : words) {
+      sink += static_cast<unsigned>(fn(w));
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  // Не даём компилятору выбросить цикл
+  if (sink == 0xFFFFFFFFu) std::puts("");
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  return ns / (static_cast<double>(words.size()) * rounds);
+}
+
+}  // namespace
+
+int main() {
+  // Обе реализации обязаны классифицировать одинаково
+  for (const auto& kw : kKeywords) {
+    if (checkKeyword(kw.text) != legacyCheckKeyword(kw.text)) {
+      std::fprintf(stderr, "mismatch on keyword %.*s\n", static_cast<int>(kw.text.size()),
+                   kw.text.data());
+      return 1;
+    }
+  }
+
+  const int rounds = 50;
+  for (unsigned percent : {0u, 20u, 50u}) {
+    auto words = makeWords(100000, percent);
+    for (const auto& w : words) {
+      if (checkKeyword(w) != legacyCheckKeyword(w)) {
+        std::fprintf(stderr, "mismatch on %s\n", w.c_str());
+        return 1;
+      }
+    }
+    double legacy = nsPerLookup(words, rounds, legacyCheckKeyword);
+    double perfect = nsPerLookup(words, rounds, checkKeyword);
+    std::printf("keywords %3u%%: if-chain %6.2f ns, perfect hash %6.2f ns, speedup %.1fx\n",
+                percent, legacy, perfect, legacy / perfect);
+  }
+  return 0;
+}
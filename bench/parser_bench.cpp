@@ -0,0 +1,468 @@
+// parser_bench.cpp
+// Пропускная способность лексера и синтаксического анализатора на
+// синтетических исходниках разной формы, а также задержка правки в Document.
+// Результаты пишутся в JSON, чтобы прогоны можно было сравнивать между собой.
+// Каждый корпус перед замером разбирается analyzeAll(): если в нём есть
+// синтаксические ошибки, бенчмарк выводит их и завершается с кодом 1.
+//
+//   parser-bench [--size МБ] [--shape имя|all] [--iterations N] [--depth N]
+//                [--seed N] [--backend table|switch|trie] [--output файл.json]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CharScan.h"
+#include "Document.h"
+#include "Lexer.h"
+#include "SourceBuffer.h"
+#include "Syntaxer.h"
+
+namespace {
+
+struct Options {
+  double sizeMb = 4.0;
+  std::string shape = "all";
+  int iterations = 5;
+  int depth = 24;
+  unsigned seed = 1;
+  LexerBackend backend = LexerBackend::Table;
+  std::string output;
+};
+
+// ---------------------------------------------------------------------------
+// Генератор корпуса
+// ---------------------------------------------------------------------------
+
+class CorpusGenerator {
+ public:
+  CorpusGenerator(unsigned seed, int depth) : rng_(seed), depth_(depth) {}
+
+  // Глубоко вложенные выражения внутри функций и объявлений переменных
+  void expressions(std::string& out) {
+    size_t n = counter_++;
+    out += "function f" + std::to_string(n) + "(a: Int, b: Float): Int {\n";
+    for (int i = 0; i < 4; ++i) {
+      out += "  let v" + std::to_string(i) + " = ";
+      expression(out, depth_);
+      out += "\n";
+    }
+    out += "  a + ";
+    expression(out, depth_ / 2);
+    out += ";\n}\n\n";
+  }
+
+  // Эндпоинты, как в config/program.txt. Синтаксиса блоков эндпоинтов в
+  // грамматике пока нет, поэтому каждый блок записан функцией-обработчиком
+  // с теми же частями: middleware, параметры запроса, поиск и ответ
+  void endpoints(std::string& out) {
+    static const char* verbs[] = {"GET", "POST", "PUT", "DELETE"};
+    static const char* resources[] = {"users", "orders", "items", "sessions"};
+    size_t n = counter_++;
+    const char* verb = verbs[pick(std::size(verbs))];
+    const char* resource = resources[pick(std::size(resources))];
+    std::string handler = "handler" + std::to_string(n);
+    out += "// ";
+    out += verb;
+    out += ' ';
+    out += resource;
+    out += '.' + handler + " с middleware auth и logRequest\n";
+    out += "function " + handler + "(id: Int, limit: Int): Response {\n";
+    out += "  auth(request, \"";
+    out += resource;
+    out += "\");\n";
+    out += "  logRequest(request.path, \"";
+    out += verb;
+    out += "\", id);\n";
+    out += "  let found = ";
+    out += resource;
+    out += ".find" + std::to_string(n) + "(id, limit)\n";
+    out += "  let ok = found != false && limit > 0\n";
+    out += "  respond(200, ok, \"Done\");\n";
+    out += "  respond(404, !ok, \"Not found\");\n";
+    out += "}\n\n";
+  }
+
+  // Много комментариев вокруг редких объявлений
+  void comments(std::string& out) {
+    size_t n = counter_++;
+    for (int i = 0; i < 6; ++i) {
+      out += "// Однострочный комментарий номер " + std::to_string(n) + '.' + std::to_string(i) +
+             " с текстом, который лексер должен пропустить целиком\n";
+    }
+    out += "/*\n";
+    for (int i = 0; i < 8; ++i) {
+      out += "   * Многострочный комментарий: let x = 1 + 2; function ignored() {}\n";
+    }
+    out += "*/\n";
+    out += "let c" + std::to_string(n) + " = " + std::to_string(n) + "\n\n";
+  }
+
+  // Длинные строковые литералы, часть с escape-последовательностями
+  void strings(std::string& out) {
+    size_t n = counter_++;
+    out += "let s" + std::to_string(n) + " = \"";
+    size_t length = 200 + pick(1800);
+    for (size_t i = 0; i < length; ++i) {
+      if (pick(64) == 0) {
+        out += pick(2) ? "\\n" : "\\\"";
+      } else {
+        out += static_cast<char>('a' + pick(26));
+      }
+    }
+    out += "\"\n";
+  }
+
+  // Всё вперемешку
+  void mixed(std::string& out) {
+    switch (pick(4)) {
+      case 0: expressions(out); break;
+      case 1: endpoints(out); break;
+      case 2: comments(out); break;
+      default: strings(out); break;
+    }
+  }
+
+ private:
+  std::mt19937 rng_;
+  int depth_;
+  size_t counter_ = 0;
+
+  size_t pick(size_t n) { return rng_() % n; }
+
+  void atom(std::string& out) {
+    switch (pick(5)) {
+      case 0: out += "a"; break;
+      case 1: out += std::to_string(pick(100000)); break;
+      case 2: out += std::to_string(pick(1000)) + '.' + std::to_string(pick(1000)); break;
+      case 3: out += pick(2) ? "true" : "false"; break;
+      default: out += "\"s" + std::to_string(pick(100)) + '"'; break;
+    }
+  }
+
+  // Цепочка глубины depth: одна ветвь каждого узла - снова выражение,
+  // поэтому размер растёт линейно по глубине
+  void expression(std::string& out, int depth) {
+    static const char* ops[] = {" + ", " - ", " * ", " / ", " % ", " == ", " != ",
+                                " < ", " >= ", " && ", " || "};
+    if (depth <= 0) {
+      atom(out);
+      return;
+    }
+    if (pick(4) == 0) out += pick(2) ? "!" : "-";
+    out += '(';
+    if (pick(2)) {
+      atom(out);
+      out += ops[pick(std::size(ops))];
+      expression(out, depth - 1);
+    } else {
+      expression(out, depth - 1);
+      out += ops[pick(std::size(ops))];
+      atom(out);
+    }
+    out += ')';
+  }
+};
+
+using ShapeFn = void (CorpusGenerator::*)(std::string&);
+
+struct Shape {
+  const char* name;
+  ShapeFn generate;
+};
+
+constexpr Shape kShapes[] = {
+    {"expressions", &CorpusGenerator::expressions},
+    {"endpoints", &CorpusGenerator::endpoints},
+    {"comments", &CorpusGenerator::comments},
+    {"strings", &CorpusGenerator::strings},
+    {"mixed", &CorpusGenerator::mixed},
+};
+
+std::string generate(const Shape& shape, const Options& options) {
+  CorpusGenerator generator(options.seed, options.depth);
+  size_t target = static_cast<size_t>(options.sizeMb * 1024 * 1024);
+  std::string out;
+  out.reserve(target + 4096);
+  while (out.size() < target) {
+    (generator.*shape.generate)(out);
+  }
+  return out;
+}
+
+// ---------------------------------------------------------------------------
+// Замеры
+// ---------------------------------------------------------------------------
+
+struct Measurement {
+  double seconds = 0;  // лучшее время из всех повторов
+  std::string error;   // непустая, если этап не прошёл
+};
+
+// Лучшее из iterations время одного вызова fn
+Measurement measure(int iterations, const std::function<void()>& fn) {
+  Measurement m;
+  m.seconds = 1e300;
+  for (int i = 0; i < iterations; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+      fn();
+    } catch (const std::exception& e) {
+      m.error = e.what();
+      return m;
+    }
+    auto end = std::chrono::steady_clock::now();
+    m.seconds = std::min(m.seconds, std::chrono::duration<double>(end - start).count());
+  }
+  return m;
+}
+
+// Задержка одной правки Document: вставка символа в случайном месте и его
+// удаление, как при наборе и стирании
+struct EditLatency {
+  double medianUs = 0;
+  double p99Us = 0;
+};
+
+constexpr int kEdits = 500;
+
+EditLatency measureEdits(const SourceBuffer& source, const Options& options) {
+  SymbolTable symbols;
+  Document doc(source.view(), options.backend, symbols);
+  std::mt19937 rng(options.seed);
+  std::vector<double> us;
+  us.reserve(2 * kEdits);
+  auto timed = [&](const TextEdit& change) {
+    auto start = std::chrono::steady_clock::now();
+    doc.edit(change);
+    auto end = std::chrono::steady_clock::now();
+    us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+  };
+  for (int i = 0; i < kEdits; ++i) {
+    size_t offset = rng() % (doc.size() + 1);
+    timed({offset, 0, "x"});
+    timed({offset, 1, ""});
+  }
+  std::sort(us.begin(), us.end());
+  return {us[us.size() / 2], us[us.size() * 99 / 100]};
+}
+
+struct Result {
+  const char* shape;
+  size_t bytes;
+  size_t tokens;
+  Measurement tokenize;
+  Measurement analyze;
+  Measurement analyzeParallel;
+  EditLatency edit;
+};
+
+// Замер разбора корпуса с ошибками мерил бы остановку на первой из них,
+// поэтому такой корпус - ошибка самого бенчмарка
+void checkCorpus(const Shape& shape, const std::vector<Token>& tokens,
+                 const std::shared_ptr<const SourceBuffer>& source) {
+  SyntaxAnalyzer analyzer(tokens, source);
+  if (analyzer.analyzeAll()) {
+    return;
+  }
+  const std::vector<Diagnostic>& diagnostics = analyzer.diagnostics();
+  std::fprintf(stderr, "%s: generated corpus has %zu syntax errors\n", shape.name,
+               diagnostics.size());
+  for (size_t i = 0; i < diagnostics.size() && i < 5; ++i) {
+    const Diagnostic& d = diagnostics[i];
+    std::fprintf(stderr, "  %d:%d: %s\n", d.line, d.column, d.message.c_str());
+  }
+  std::exit(1);
+}
+
+Result run(const Shape& shape, const Options& options) {
+  auto source = SourceBuffer::fromString(generate(shape, options));
+
+  Result result{shape.name, source->size(), 0, {}, {}, {}, {}};
+  result.tokenize = measure(options.iterations, [&] {
+    SymbolTable symbols;
+    Lexer lexer(source, options.backend, symbols);
+    result.tokens = lexer.tokenize().size();
+  });
+
+  // Разбор меряется отдельно, по заранее полученному массиву токенов
+  SymbolTable symbols;
+  Lexer lexer(source, options.backend, symbols);
+  std::vector<Token> tokens = lexer.tokenize();
+  checkCorpus(shape, tokens, source);
+  result.analyze = measure(options.iterations, [&] {
+    SyntaxAnalyzer analyzer(tokens, source);
+    analyzer.analyze();
+  });
+  result.analyzeParallel = measure(options.iterations, [&] {
+    SyntaxAnalyzer analyzer(tokens, source);
+    analyzer.analyzeParallel();
+  });
+  result.edit = measureEdits(*source, options);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+// Вывод
+// ---------------------------------------------------------------------------
+
+std::string jsonString(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof buf, "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out + '"';
+}
+
+void writeStage(std::FILE* f, const char* name, const Measurement& m, const Result& r, bool last) {
+  if (!m.error.empty()) {
+    std::fprintf(f, "      \"%s\": {\"error\": %s}%s\n", name, jsonString(m.error).c_str(),
+                 last ? "" : ",");
+    return;
+  }
+  std::fprintf(f,
+               "      \"%s\": {\"seconds\": %.6f, \"mb_per_s\": %.2f, \"tokens_per_s\": %.0f}%s\n",
+               name, m.seconds, r.bytes / (1024.0 * 1024.0) / m.seconds, r.tokens / m.seconds,
+               last ? "" : ",");
+}
+
+void writeJson(std::FILE* f, const Options& options, const std::vector<Result>& results) {
+  static const char* levels[] = {"scalar", "sse2", "avx2"};
+  std::fprintf(f, "{\n");
+  std::fprintf(f, "  \"size_mb\": %.2f,\n", options.sizeMb);
+  std::fprintf(f, "  \"iterations\": %d,\n", options.iterations);
+  std::fprintf(f, "  \"depth\": %d,\n", options.depth);
+  std::fprintf(f, "  \"seed\": %u,\n", options.seed);
+  static const char* backends[] = {"switch", "table", "trie"};
+  std::fprintf(f, "  \"backend\": \"%s\",\n", backends[static_cast<int>(options.backend)]);
+  std::fprintf(f, "  \"simd\": \"%s\",\n", levels[static_cast<int>(charscan::activeLevel())]);
+  std::fprintf(f, "  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    std::fprintf(f, "    {\n");
+    std::fprintf(f, "      \"shape\": \"%s\",\n", r.shape);
+    std::fprintf(f, "      \"bytes\": %zu,\n", r.bytes);
+    std::fprintf(f, "      \"tokens\": %zu,\n", r.tokens);
+    writeStage(f, "tokenize", r.tokenize, r, false);
+    writeStage(f, "analyze", r.analyze, r, false);
+    writeStage(f, "analyze_parallel", r.analyzeParallel, r, false);
+    std::fprintf(f, "      \"edit\": {\"median_us\": %.2f, \"p99_us\": %.2f}\n", r.edit.medianUs,
+                 r.edit.p99Us);
+    std::fprintf(f, "    }%s\n", i + 1 == results.size() ? "" : ",");
+  }
+  std::fprintf(f, "  ]\n}\n");
+}
+
+void printSummary(const Result& r) {
+  auto stage = [&](const char* name, const Measurement& m) {
+    if (!m.error.empty()) {
+      std::fprintf(stderr, "  %-8s failed: %s\n", name, m.error.c_str());
+    } else {
+      std::fprintf(stderr, "  %-8s %9.2f MB/s %12.0f tokens/s\n", name,
+                   r.bytes / (1024.0 * 1024.0) / m.seconds, r.tokens / m.seconds);
+    }
+  };
+  std::fprintf(stderr, "%s: %zu bytes, %zu tokens\n", r.shape, r.bytes, r.tokens);
+  stage("tokenize", r.tokenize);
+  stage("analyze", r.analyze);
+  stage("parallel", r.analyzeParallel);
+  std::fprintf(stderr, "  %-8s %9.2f us median %9.2f us p99\n", "edit", r.edit.medianUs, r.edit.p99Us);
+}
+
+[[noreturn]] void usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--size MB] [--shape all|expressions|endpoints|comments|strings|mixed]\n"
+               "          [--iterations N] [--depth N] [--seed N] [--backend table|switch|trie]\n"
+               "          [--output file.json]\n",
+               argv0);
+  std::exit(2);
+}
+
+Options parseOptions(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) usage(argv[0]);
+    const char* value = argv[++i];
+    if (arg == "--size") {
+      options.sizeMb = std::atof(value);
+    } else if (arg == "--shape") {
+      options.shape = value;
+    } else if (arg == "--iterations") {
+      options.iterations = std::max(1, std::atoi(value));
+    } else if (arg == "--depth") {
+      options.depth = std::max(0, std::atoi(value));
+    } else if (arg == "--seed") {
+      options.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--backend") {
+      if (std::strcmp(value, "table") == 0) {
+        options.backend = LexerBackend::Table;
+      } else if (std::strcmp(value, "switch") == 0) {
+        options.backend = LexerBackend::Switch;
+      } else if (std::strcmp(value, "trie") == 0) {
+        options.backend = LexerBackend::Trie;
+      } else {
+        usage(argv[0]);
+      }
+    } else if (arg == "--output") {
+      options.output = value;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options = parseOptions(argc, argv);
+
+  std::vector<Result> results;
+  for (const Shape& shape : kShapes) {
+    if (options.shape == "all" || options.shape == shape.name) {
+      results.push_back(run(shape, options));
+      printSummary(results.back());
+    }
+  }
+  if (results.empty()) {
+    usage(argv[0]);
+  }
+
+  std::FILE* f = stdout;
+  if (!options.output.empty()) {
+    f = std::fopen(options.output.c_str(), "w");
+    if (!f) {
+      std::perror(options.output.c_str());
+      return 1;
+    }
+  }
+  writeJson(f, options, results);
+  if (f != stdout) {
+    std::fclose(f);
+  }
+  for (const Result& r : results) {
+    if (!r.tokenize.error.empty() || !r.analyze.error.empty() || !r.analyzeParallel.error.empty()) {
+      return 1;
+    }
+  }
+  return 0;
+}
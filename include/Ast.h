@@ -0,0 +1,135 @@
+// Ast.h
+#ifndef AST_H
+#define AST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "SymbolTable.h"
+#include "TokenType.h"
+
+// Номер узла в дереве; узлы ссылаются друг на друга номерами, не указателями
+using NodeId = uint32_t;
+inline constexpr NodeId kNoNode = UINT32_MAX;
+
+enum class NodeKind : uint8_t {
+  Program,              // дети: операторы верхнего уровня
+  FunctionDecl,         // имя; дети: Parameter*, Type? (возвращаемый), Block
+  Parameter,            // имя; ребёнок: Type
+  Type,                 // имя типа
+  Block,                // дети: операторы
+  VariableDecl,         // имя, op = KW_LET | KW_VAR; ребёнок: инициализатор
+  ExpressionStatement,  // ребёнок: выражение
+  Binary,               // op (в том числе . -> =>); дети: левый и правый операнды
+  Unary,                // op; ребёнок: операнд
+  Call,                 // дети: вызываемое выражение, аргументы
+  Literal,              // op = вид литерала, значение в value
+  Identifier,           // имя
+};
+
+// Узел синтаксического дерева. Дети образуют односвязный список:
+// firstChild, затем nextSibling у каждого ребёнка.
+struct AstNode {
+  NodeKind kind;
+  // Оператор (Binary, Unary), вид литерала (Literal) или ключевое слово
+  TokenType op;
+  // Смещение начального токена в исходном тексте
+  uint32_t offset;
+  // Имя (Identifier, объявления, Type)
+  SymbolId symbol;
+  NodeId firstChild;
+  NodeId nextSibling;
+  // Текст токена: имя или литерал как в исходнике (строка - раскодированная)
+  std::string_view text;
+  // Значение литерала, как в Token
+  union {
+    int64_t intValue;
+    double floatValue;
+    bool boolValue;
+  };
+};
+
+// Без деструкторов: всё дерево освобождается сбросом счётчика
+static_assert(std::is_trivially_destructible_v<AstNode>);
+
+// Дерево в арене: узлы лежат блоками по kChunkSize подряд, новый узел - это
+// просто следующий свободный элемент (выделение памяти - раз на блок).
+// clear() за O(1) делает все узлы недействительными и оставляет блоки для
+// повторного использования, например при разборе следующего файла.
+class Ast {
+ public:
+  static constexpr size_t kChunkBits = 10;
+  static constexpr size_t kChunkSize = size_t{1} << kChunkBits;
+
+  Ast() = default;
+  Ast(Ast&&) = default;
+  Ast& operator=(Ast&&) = default;
+
+  // Новый узел без детей
+  NodeId add(NodeKind kind, uint32_t offset, TokenType op = TokenType::Unknown);
+
+  AstNode& operator[](NodeId id) {
+    return chunks_[id >> kChunkBits][id & (kChunkSize - 1)];
+  }
+  const AstNode& operator[](NodeId id) const {
+    return chunks_[id >> kChunkBits][id & (kChunkSize - 1)];
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  NodeId root() const { return root_; }
+  void setRoot(NodeId id) { root_ = id; }
+
+  void clear() {
+    size_ = 0;
+    root_ = kNoNode;
+  }
+
+  // Копирует узлы other с номерами [begin, end) в конец дерева и возвращает
+  // номер копии begin; ссылки внутри диапазона сдвигаются вместе с узлами
+  NodeId append(const Ast& other, NodeId begin, NodeId end);
+  NodeId append(const Ast& other) { return append(other, 0, static_cast<NodeId>(other.size())); }
+
+  // Число детей узла
+  size_t childCount(NodeId id) const;
+
+  // S-выражение поддерева для отладки: (Binary + (Identifier a) (Literal 1))
+  std::string dump(NodeId id) const;
+  std::string dump() const { return root_ == kNoNode ? std::string() : dump(root_); }
+
+ private:
+  void dump(NodeId id, std::string& out) const;
+
+  std::vector<std::unique_ptr<AstNode[]>> chunks_;
+  size_t size_ = 0;
+  NodeId root_ = kNoNode;
+};
+
+// Построение списка детей в порядке добавления: хвост хранится здесь, а не
+// в каждом узле
+class ChildList {
+ public:
+  ChildList(Ast& ast, NodeId parent) : ast_(ast), parent_(parent) {}
+
+  void append(NodeId child) {
+    if (last_ == kNoNode) {
+      ast_[parent_].firstChild = child;
+    } else {
+      ast_[last_].nextSibling = child;
+    }
+    last_ = child;
+  }
+
+ private:
+  Ast& ast_;
+  NodeId parent_;
+  NodeId last_ = kNoNode;
+};
+
+#endif  // AST_H
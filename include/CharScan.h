@@ -0,0 +1,81 @@
+// CharScan.h
+#ifndef CHAR_SCAN_H
+#define CHAR_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Векторный поиск границ лексем для лексера.
+// Каждая функция принимает диапазон [p, end) и возвращает указатель на первый
+// символ, который прерывает серию (или end). Классы символов совпадают с
+// isspace/isalnum/isdigit в локали "C": байты >= 0x80 ни в один класс не входят.
+//
+// Реализации: скалярная, SSE2 (базовая для x86-64) и AVX2 (выбирается при
+// запуске, если процессор её поддерживает). Результаты всех реализаций
+// совпадают побайтово.
+namespace charscan {
+
+enum class Level {
+  Scalar,
+  SSE2,
+  AVX2,
+};
+
+struct Kernels {
+  // Первый символ, не являющийся пробельным
+  const char* (*skipWhitespace)(const char* p, const char* end);
+  // Первый '\n' или '\0' (конец однострочного комментария)
+  const char* (*findLineEnd)(const char* p, const char* end);
+  // Первый '*' или '\0' (кандидат на конец многострочного комментария)
+  const char* (*findStarOrNul)(const char* p, const char* end);
+  // Первый символ не из [A-Za-z0-9_]
+  const char* (*identifierEnd)(const char* p, const char* end);
+  // Первый символ не из [0-9]
+  const char* (*digitsEnd)(const char* p, const char* end);
+  // Количество '\n' в диапазоне
+  size_t (*countNewlines)(const char* p, const char* end);
+  // Смещения (от p) всех '\n' диапазона записываются в out по возрастанию;
+  // возвращает их количество. out должен вмещать end - p элементов.
+  size_t (*findNewlines)(const char* p, const char* end, uint32_t* out);
+};
+
+// Текущий набор реализаций (по умолчанию - лучший из доступных)
+const Kernels& kernels();
+
+Level activeLevel();
+// Самый быстрый уровень, поддерживаемый процессором
+Level bestLevel();
+// Переключает реализацию; уровень выше поддерживаемого понижается до bestLevel()
+void setLevel(Level level);
+
+inline const char* skipWhitespace(const char* p, const char* end) {
+  return kernels().skipWhitespace(p, end);
+}
+
+inline const char* findLineEnd(const char* p, const char* end) {
+  return kernels().findLineEnd(p, end);
+}
+
+// Конец многострочного комментария: указатель на '*' из "*/", либо на '\0',
+// либо end, если комментарий не закрыт
+const char* findBlockCommentEnd(const char* p, const char* end);
+
+inline const char* identifierEnd(const char* p, const char* end) {
+  return kernels().identifierEnd(p, end);
+}
+
+inline const char* digitsEnd(const char* p, const char* end) {
+  return kernels().digitsEnd(p, end);
+}
+
+inline size_t countNewlines(const char* p, const char* end) {
+  return kernels().countNewlines(p, end);
+}
+
+inline size_t findNewlines(const char* p, const char* end, uint32_t* out) {
+  return kernels().findNewlines(p, end, out);
+}
+
+}  // namespace charscan
+
+#endif  // CHAR_SCAN_H
@@ -0,0 +1,125 @@
+// Document.h
+#ifndef DOCUMENT_H
+#define DOCUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Ast.h"
+#include "Lexer.h"
+#include "Syntaxer.h"
+
+// Правка текста: length байт с offset заменяются на text
+struct TextEdit {
+  size_t offset;
+  size_t length;
+  std::string_view text;
+};
+
+// Исходник, открытый в редакторе: после каждой правки заново лексится и
+// разбирается только затронутый участок.
+//
+// Текст хранится кусками по объявлениям верхнего уровня - те же границы, что
+// у параллельного разбора (function, let, var, GET/POST/PUT/DELETE вне
+// фигурных скобок). У каждого куска свой буфер, свои токены и своё поддерево.
+// Правка заменяет текст кусков, которые она задевает, и участок заново
+// режется на куски. Если границы сдвинулись (незакрытая скобка или
+// комментарий, слово, слипшееся с ключевым словом соседа), участок
+// расширяется на соседние куски, пока его края снова не совпадут с границами
+// полного разбора. Остальные куски и их поддеревья не трогаются.
+//
+// Дерево и ошибки совпадают с разбором всего текста через analyzeAll().
+class Document {
+ public:
+  // Имена интернируются в собственную таблицу документа. Она пересобирается
+  // вместе с деревом (compact), поэтому в ней остаются только имена живых
+  // узлов и правок после последней пересборки.
+  explicit Document(std::string_view text,
+                    LexerBackend backend = LexerBackend::Table);
+  // Имена интернируются в symbols, которая не пересобирается: она растёт на
+  // все имена, когда-либо появлявшиеся в тексте, и должна пережить документ.
+  Document(std::string_view text, LexerBackend backend, SymbolTable& symbols);
+
+  // Бросает std::out_of_range, если диапазон выходит за конец текста
+  void edit(const TextEdit& change);
+
+  size_t size() const { return size_; }
+  // Текст целиком (собирается из кусков)
+  std::string text() const;
+
+  // Дерево всего документа: корень - Program, его дети - операторы верхнего
+  // уровня в порядке текста. Смещения в узлах отсчитываются от начала куска;
+  // смещение от начала документа даёт offsetOf.
+  const Ast& ast() const { return ast_; }
+  uint32_t offsetOf(NodeId id) const;
+
+  // Ошибки всех кусков с позициями от начала документа
+  std::vector<Diagnostic> diagnostics() const;
+  size_t diagnosticCount() const { return diagnosticCount_; }
+
+  size_t declarationCount() const { return segments_.size(); }
+
+  // Таблица имён, на которую ссылаются узлы ast()
+  const SymbolTable& symbols() const { return *symbols_; }
+
+ private:
+  struct Segment {
+    // Лексер куска владеет его текстом и раскодированными строками, на
+    // которые ссылаются узлы дерева
+    std::unique_ptr<Lexer> lexer;
+    // Первый токен следующего куска, который видел разбор
+    TokenType next = TokenType::EndOfFile;
+    // Узлы куска в ast_ идут подряд: [firstNode, endNode)
+    NodeId firstNode = 0;
+    NodeId endNode = 0;
+    // Операторы верхнего уровня куска, связанные через nextSibling
+    NodeId firstStatement = kNoNode;
+    NodeId lastStatement = kNoNode;
+    // Позиции - от начала куска
+    std::vector<Diagnostic> diagnostics;
+    // Переводов строк в тексте и кодовых точек после последнего из них -
+    // по ним позиция внутри куска переводится в позицию в документе
+    size_t newlines = 0;
+    size_t tailColumns = 0;
+
+    std::string_view text() const { return lexer->sourceBuffer()->view(); }
+  };
+
+  // Куски [first, last) заменяются текстом text
+  void replace(size_t first, size_t last, std::string text);
+  Segment build(std::string_view text, TokenType next);
+  // Заново связывает операторы кусков [first, last) с соседями
+  void link(size_t first, size_t last);
+  void compact();
+  void compactSymbols();
+  size_t segmentAt(size_t offset) const;
+
+  LexerBackend backend_;
+  // Своя таблица имён, если её не передали в конструктор
+  std::unique_ptr<SymbolTable> ownSymbols_;
+  SymbolTable* symbols_;
+  // Имён в своей таблице после последней пересборки
+  size_t liveSymbols_ = 0;
+  // Где кусок лежит в документе. Отдельно от кусков: после правки места
+  // сдвигаются до конца документа, а ошибки ищутся проходом по всем кускам,
+  // и плотный массив проходится быстро.
+  struct Place {
+    size_t start = 0;   // смещение
+    uint32_t line = 1;  // строка начала
+    uint32_t diagnostics = 0;
+  };
+
+  std::vector<Segment> segments_;
+  std::vector<Place> places_;
+  size_t size_ = 0;
+  // Узлы всех кусков; узлы заменённых кусков остаются мусором до compact()
+  Ast ast_;
+  size_t liveNodes_ = 0;
+  size_t diagnosticCount_ = 0;
+};
+
+#endif  // DOCUMENT_H
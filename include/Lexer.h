@@ -3,39 +3,105 @@
 #define LEXER_H
 
 #include <cctype>
+#include <list>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
-#include "Token.h"
+#include "SourceBuffer.h"
+#include "SymbolTable.h"
+#include "ThreadPool.h"
+#include "token.h"
+
+// Способ распознавания токенов; результат у всех одинаковый
+enum class LexerBackend {
+  Switch,  // switch по текущему символу
+  Table,   // классы символов и автомат операторов (OperatorDfa)
+  Trie,    // ключевые слова и операторы за один проход по префиксным деревьям (LexerTries)
+};
 
 class Lexer {
  public:
-  Lexer(const std::string& input)
-      : input(input),
+  Lexer(const std::string& input, LexerBackend backend = LexerBackend::Table)
+      : Lexer(SourceBuffer::fromString(input), backend) {}
+
+  // Лексер без копирования поверх готового буфера (например,
+  // SourceBuffer::mapFile). Значения токенов ссылаются прямо в буфер.
+  // Идентификаторы интернируются в symbols.
+  explicit Lexer(std::shared_ptr<const SourceBuffer> source,
+                 LexerBackend backend = LexerBackend::Table,
+                 SymbolTable& symbols = SymbolTable::global())
+      : source(std::move(source)),
+        backend(backend),
+        symbols(&symbols),
+        input(this->source->view()),
         position(0),
         readPosition(0),
-        currentChar('\0'),
-        line(1),
-        column(0) {
+        currentChar('\0') {
     readChar();
   }
 
   std::vector<Token> tokenize();
 
+  // Параллельная токенизация всего буфера: ввод режется по переводам строк
+  // вне строковых литералов и комментариев, куски лексятся на пуле потоков.
+  // Результат совпадает с tokenize() токен в токен.
+  std::vector<Token> tokenizeParallel(ThreadPool& pool = ThreadPool::shared());
+
+  // Следующий токен по запросу, без построения массива (см. TokenStream)
+  Token next();
+
+  const std::shared_ptr<const SourceBuffer>& sourceBuffer() const {
+    return source;
+  }
+
+  SymbolTable& symbolTable() const { return *symbols; }
+
  private:
-  std::string input;
+  // Лексер куска [begin, end) того же буфера
+  Lexer(std::shared_ptr<const SourceBuffer> source, LexerBackend backend,
+        SymbolTable& symbols, size_t begin, size_t end)
+      : source(std::move(source)),
+        backend(backend),
+        symbols(&symbols),
+        input(this->source->view().substr(0, end)),
+        position(begin),
+        readPosition(begin),
+        currentChar('\0') {
+    readChar();
+  }
+
+  std::shared_ptr<const SourceBuffer> source;
+  LexerBackend backend;
+  SymbolTable* symbols;
+  // Имена, которые этот лексер уже внёс в symbols, и их номера: общая
+  // таблица блокируется один раз на каждое различное имя, а не на каждый
+  // идентификатор
+  std::unordered_map<std::string_view, SymbolId> interned;
+  std::string_view input;
+  // Строки, которых нет в исходном тексте дословно (литералы с escape-
+  // последовательностями). std::list не перемещает элементы, поэтому
+  // string_view на них остаются действительными.
+  std::list<std::string> decoded;
   size_t position;
   size_t readPosition;
   char currentChar;
-  int line;
-  int column;
 
   void readChar();
+  void advanceTo(size_t target);
   char peekChar();
   void skipWhitespace();
   void skipComment();
+  std::string_view storeDecoded(std::string str);
+  SymbolId intern(std::string_view name);
   Token nextToken();
+  Token nextTokenTable();
+  Token nextTokenTrie();
+  Token nextTokenSwitch();
   Token identifier();
+  Token word(size_t startPos, TokenType type);
   Token number();
   Token stringLiteral();
   Token listLiteral();
@@ -0,0 +1,43 @@
+// LexerTries.h
+#ifndef LEXER_TRIES_H
+#define LEXER_TRIES_H
+
+#include <string>
+
+#include "trie.h"
+
+// Префиксные деревья для LexerBackend::Trie. Значение слова - его TokenType.
+//  - ключевые слова: config/keywords.txt и таблица kKeywords. Слова файла,
+//    которые checkKeyword не считает ключевыми (имена типов, "_"), остаются
+//    идентификаторами, чтобы результат не зависел от выбранного лексера;
+//  - операторы и разделители: таблица kOperators.
+//
+// Готовые деревья кэшируются образами (Trie::Save) в каталоге cacheDir:
+// следующий процесс отображает их в память вместо построения. Отпечаток
+// образа - хеш файла ключевых слов и встроенных таблиц, поэтому после их
+// изменения образ перестраивается.
+class LexerTries {
+ public:
+  // Путь к файлу ключевых слов: переменная окружения ELANG_KEYWORDS, иначе
+  // config/keywords.txt из дерева исходников
+  static std::string defaultKeywordsPath();
+  // Каталог образов: переменная окружения ELANG_TRIE_CACHE, иначе каталог
+  // сборки. Пустая строка отключает кэш.
+  static std::string defaultCacheDir();
+
+  // Деревья по умолчанию, строятся при первом обращении
+  static const LexerTries& instance();
+
+  // Отсутствующий файл не ошибка: берутся только встроенные таблицы.
+  // Ошибка записи образа тоже не ошибка: деревья просто не кэшируются.
+  explicit LexerTries(const std::string& keywordsPath, const std::string& cacheDir = "");
+
+  const Trie& keywords() const { return keywords_; }
+  const Trie& operators() const { return operators_; }
+
+ private:
+  Trie keywords_;
+  Trie operators_;
+};
+
+#endif  // LEXER_TRIES_H
@@ -0,0 +1,70 @@
+// OperatorDfa.h
+#ifndef OPERATOR_DFA_H
+#define OPERATOR_DFA_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TokenType.h"
+
+// Класс первого символа токена: по нему табличный лексер выбирает ветку
+enum class CharKind : uint8_t {
+  Other,       // неизвестный символ
+  Space,       // пробельный символ
+  IdentStart,  // [A-Za-z_]
+  Digit,       // [0-9]
+  Quote,       // "
+  Operator,    // начало оператора или разделителя из kOperators
+  End,         // '\0'
+};
+
+// Детерминированный автомат для операторов и разделителей, строится при
+// запуске по таблице kOperators. Символы сжимаются в классы (по одному на
+// каждый символ, встречающийся в операторах), переход - одно чтение из
+// плоской таблицы состояний. Поиск идёт по правилу максимального
+// совпадения: из "==" получается OP_EQUAL, а не два OP_ASSIGN.
+class OperatorDfa {
+ public:
+  struct Match {
+    size_t length;  // 0 - оператор не распознан
+    TokenType type;
+  };
+
+  static const OperatorDfa& instance();
+
+  CharKind kind(char c) const { return kinds_[static_cast<unsigned char>(c)]; }
+
+  Match match(const char* p, const char* end) const {
+    Match result{0, TokenType::Unknown};
+    uint16_t state = kStart;
+    for (const char* q = p; q < end; ++q) {
+      state = next_[state * classCount_ + classes_[static_cast<unsigned char>(*q)]];
+      if (state == kDead) {
+        break;
+      }
+      if (accept_[state] != TokenType::Unknown) {
+        result = {static_cast<size_t>(q - p + 1), accept_[state]};
+      }
+    }
+    return result;
+  }
+
+  size_t stateCount() const { return accept_.size(); }
+
+ private:
+  OperatorDfa();
+
+  static constexpr uint16_t kDead = 0;
+  static constexpr uint16_t kStart = 1;
+
+  std::array<CharKind, 256> kinds_{};
+  // Класс 0 - символ не встречается ни в одном операторе
+  std::array<uint8_t, 256> classes_{};
+  size_t classCount_ = 1;
+  std::vector<uint16_t> next_;      // [состояние * classCount_ + класс]
+  std::vector<TokenType> accept_;   // Unknown - состояние не допускающее
+};
+
+#endif  // OPERATOR_DFA_H
@@ -1,19 +1,52 @@
+#ifndef ELANG_RPN_H
+#define ELANG_RPN_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "SymbolTable.h"
+
 namespace elangRPN {
 
+// Variables, parameters and function names are referred to by interned
+// symbol id, so lookups hash an integer instead of a string.
+inline SymbolId symbol(std::string_view name) {
+  return SymbolTable::global().intern(name);
+}
+
 enum class TokenType {
   Operand,
   Operator,
   Function,
   ControlFlow,
   Variable,
+  // Resolved variable access, operand is a Slot: LoadLocal/StoreLocal index
+  // a frame slot, LoadGlobal/StoreGlobal a global by SymbolId
+  LoadLocal,
+  StoreLocal,
+  LoadGlobal,
+  StoreGlobal,
+  // Produced by Expression::link, operand is a Target. The conditional jumps
+  // pop the condition.
+  Jump,
+  JumpIfFalse,
+  JumpIfTrue,
+  // Operand is an Arity: calls the value on top with the count values below
+  // it as arguments and leaves one result in place of all of them
+  Call,
 };
 
 enum class OperatorType {
@@ -33,17 +66,19 @@ enum class OperatorType {
   Negate,
   LogicalNot,
   Duplicate,
+  Pop,  // drops the value of an expression statement
   Assign,
   AccessProperty,
-  FunctionCall,
 };
 
+// Structured control flow as emitted; Expression::link turns it into jumps
 enum class ControlFlowType {
   If,
   Else,
   EndIf,
   While,
   EndWhile,
+  Return,  // ends the expression with the value on top of the stack
 };
 
 class Expression;
@@ -55,27 +90,41 @@ class ElgPrimitive {
   class Undefined {};
   class Function {
    public:
-    std::vector<std::string> parameters;
+    std::vector<SymbolId> parameters;
     std::shared_ptr<Expression> expression;
-    std::string name;  // Added to support recursion
+    SymbolId name;  // Added to support recursion
+    // Set by the resolver: the body addresses parameters and locals as frame
+    // slots 0..slots-1 (parameters first) instead of a Context
+    bool resolved = false;
+    uint32_t slots = 0;
+    // Body of the lexically enclosing function, nullptr at top level
+    const Expression* enclosing = nullptr;
+
+    Function(SymbolId funcName, std::vector<SymbolId> params,
+             std::shared_ptr<Expression> expr)
+        : parameters(std::move(params)), expression(expr), name(funcName) {}
 
-    Function(const std::string& funcName,
+    Function(std::string_view funcName,
              const std::vector<std::string>& params,
              std::shared_ptr<Expression> expr)
-        : name(funcName), parameters(params), expression(expr) {}
+        : expression(expr), name(symbol(funcName)) {
+      parameters.reserve(params.size());
+      for (const auto& param : params) {
+        parameters.push_back(symbol(param));
+      }
+    }
   };
 
   using ElgPrimitiveValue =
-      std::variant<int, float, std::string, Null, Undefined, Function>;
+      std::variant<int64_t, double, std::string, Null, Undefined, Function>;
 
   ElgPrimitive(ElgPrimitiveValue value) : value(value) {}
 
   ElgPrimitiveValue value;
 };
 
-using ElgObjectValue =
-    std::variant<std::shared_ptr<ElgPrimitive>,
-                 std::unordered_map<std::string, std::shared_ptr<ElgObject>>>;
+using ObjectMap = std::unordered_map<std::string, std::shared_ptr<ElgObject>>;
+using ElgObjectValue = std::variant<std::shared_ptr<ElgPrimitive>, ObjectMap>;
 
 class ElgObject {
  public:
@@ -87,12 +136,303 @@ class ElgObject {
   }
 };
 
+// Heap part of a Value. The count is not atomic: values never leave the
+// interpreter's thread.
+struct HeapCell {
+  uint32_t refs = 1;
+  std::variant<std::string, ElgPrimitive::Function, ObjectMap> data;
+};
+
+// Operand stack element: a tag and an inline payload in 16 bytes. Ints,
+// floats, null and undefined need no allocation; strings, functions and
+// objects live in one refcounted HeapCell, so copying a value is at most
+// one non-atomic increment.
+class Value {
+ public:
+  enum class Tag : uint8_t {
+    Undefined,
+    Null,
+    Int,
+    Float,
+    // Local slot the function has not assigned yet; loads see through it
+    // (Interpreter::outerBinding), so it never leaves the slot
+    Unset,
+    // Heap tags go last: see isHeap()
+    String,
+    Function,
+    Object,
+  };
+
+  Value() : tag_(Tag::Undefined) { payload_.heap = nullptr; }
+  explicit Value(int64_t value) : Value() {
+    payload_.i = value;
+    tag_ = Tag::Int;
+  }
+  explicit Value(double value) : Value() {
+    payload_.f = value;
+    tag_ = Tag::Float;
+  }
+  explicit Value(std::string value) : Value() {
+    payload_.heap = new HeapCell{1, std::move(value)};
+    tag_ = Tag::String;
+  }
+  explicit Value(ElgPrimitive::Function value) : Value() {
+    payload_.heap = new HeapCell{1, std::move(value)};
+    tag_ = Tag::Function;
+  }
+  explicit Value(ObjectMap value) : Value() {
+    payload_.heap = new HeapCell{1, std::move(value)};
+    tag_ = Tag::Object;
+  }
+  // Boxed values from hand-built programs
+  Value(const ElgObject& object);
+
+  static Value null() {
+    Value v;
+    v.tag_ = Tag::Null;
+    return v;
+  }
+  static Value unset() {
+    Value v;
+    v.tag_ = Tag::Unset;
+    return v;
+  }
+
+  Value(const Value& other) : payload_(other.payload_), tag_(other.tag_) {
+    if (isHeap()) {
+      ++payload_.heap->refs;
+    }
+  }
+  Value(Value&& other) noexcept : payload_(other.payload_), tag_(other.tag_) {
+    other.tag_ = Tag::Undefined;
+  }
+  Value& operator=(const Value& other) {
+    Value copy(other);
+    swap(copy);
+    return *this;
+  }
+  Value& operator=(Value&& other) noexcept {
+    Value moved(std::move(other));
+    swap(moved);
+    return *this;
+  }
+  ~Value() {
+    if (isHeap() && --payload_.heap->refs == 0) {
+      release(payload_.heap);
+    }
+  }
+
+  Tag tag() const { return tag_; }
+  bool isUndefined() const { return tag_ == Tag::Undefined; }
+  bool isUnset() const { return tag_ == Tag::Unset; }
+  bool isInt() const { return tag_ == Tag::Int; }
+  bool isNumber() const { return tag_ == Tag::Int || tag_ == Tag::Float; }
+  bool isHeap() const { return tag_ >= Tag::String; }
+
+  int64_t asInt() const { return payload_.i; }
+  double asFloat() const { return payload_.f; }
+  // Int or Float as a double
+  double asNumber() const {
+    return isInt() ? static_cast<double>(payload_.i) : payload_.f;
+  }
+  const std::string& asString() const {
+    return std::get<std::string>(payload_.heap->data);
+  }
+  const ElgPrimitive::Function& asFunction() const {
+    return std::get<ElgPrimitive::Function>(payload_.heap->data);
+  }
+  const ObjectMap& asObject() const {
+    return std::get<ObjectMap>(payload_.heap->data);
+  }
+
+  // Boxed copy for code that still works with ElgObject
+  ElgObject toObject() const;
+
+  void swap(Value& other) noexcept {
+    std::swap(payload_, other.payload_);
+    std::swap(tag_, other.tag_);
+  }
+
+ private:
+  // Copied as a whole, whichever member is active
+  union Payload {
+    int64_t i;
+    double f;
+    HeapCell* heap;
+  };
+
+  Payload payload_;
+  Tag tag_;
+
+  // Kept out of the destructor, so that the refcount check inlines
+  static void release(HeapCell* cell);
+};
+
+static_assert(sizeof(Value) == 16);
+
+inline void Value::release(HeapCell* cell) { delete cell; }
+
+inline Value::Value(const ElgObject& object) : Value() {
+  if (auto map = std::get_if<ObjectMap>(&object.value)) {
+    *this = Value(*map);
+    return;
+  }
+  const auto& primitive = std::get<std::shared_ptr<ElgPrimitive>>(object.value);
+  std::visit(
+      [this](const auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, ElgPrimitive::Null>) {
+          *this = Value::null();
+        } else if constexpr (!std::is_same_v<T, ElgPrimitive::Undefined>) {
+          *this = Value(value);
+        }
+      },
+      primitive->value);
+}
+
+inline ElgObject Value::toObject() const {
+  switch (tag_) {
+    case Tag::Null:
+      return ElgObject(std::make_shared<ElgPrimitive>(ElgPrimitive::Null()));
+    case Tag::Int:
+      return ElgObject(std::make_shared<ElgPrimitive>(payload_.i));
+    case Tag::Float:
+      return ElgObject(std::make_shared<ElgPrimitive>(payload_.f));
+    case Tag::String:
+      return ElgObject(std::make_shared<ElgPrimitive>(asString()));
+    case Tag::Function:
+      return ElgObject(std::make_shared<ElgPrimitive>(asFunction()));
+    case Tag::Object:
+      return ElgObject(asObject());
+    case Tag::Undefined:
+    case Tag::Unset:
+      break;
+  }
+  return ElgObject();
+}
+
+// Operand of resolved variable access. For locals, depth counts enclosing
+// functions outwards (0 - the current one) and name is the variable, for the
+// lookup past an unset slot; for globals, index is the SymbolId and depth is
+// 0.
+struct Slot {
+  uint32_t index;
+  uint32_t depth = 0;
+  SymbolId name = kNoSymbol;
+};
+
+// Operand of jumps: absolute offset of the next token to execute
+struct Target {
+  size_t offset;
+};
+
+// Operand of calls: number of arguments at the call site
+struct Arity {
+  uint32_t count;
+};
+
 class Token {
  public:
   TokenType type;
-  std::variant<ElgObject, OperatorType, ControlFlowType, std::string> value;
+  // Value is used by Operand tokens, SymbolId by Variable tokens, Slot by
+  // Load/Store tokens, Target by jumps, Arity by calls
+  std::variant<Value, OperatorType, ControlFlowType, SymbolId, Slot, Target,
+               Arity>
+      value;
+};
+
+// Bytecode the Interpreter executes. An instruction is a one-byte opcode
+// followed by its operands as unsigned LEB128 varints; jump targets are
+// fixed 4-byte byte offsets instead, so forward jumps can be patched in
+// place. Constants and symbols are indices into the pools of the Chunk.
+enum class Opcode : uint8_t {
+  Constant,    // k: constants[k]
+  LoadName,    // s: variable symbols[s] of the current Context
+  LoadLocal,   // index: frame slot of the running function
+  StoreLocal,  // index
+  LoadOuter,   // depth index s: frame slot of an enclosing function
+  StoreOuter,  // depth index
+  LoadGlobal,  // s: global symbols[s]
+  StoreGlobal, // s
+  // One opcode per OperatorType, in the same order
+  Add,
+  Subtract,
+  Multiply,
+  Divide,
+  Modulo,
+  Equal,
+  NotEqual,
+  LessThan,
+  GreaterThan,
+  LessEqual,
+  GreaterEqual,
+  LogicalAnd,
+  LogicalOr,
+  Negate,
+  LogicalNot,
+  Duplicate,
+  Pop,
+  Assign,
+  AccessProperty,
+  Call,         // argc
+  Jump,         // target
+  JumpIfFalse,  // target
+  JumpIfTrue,   // target
+  Return,       // also ends every chunk
 };
 
+static_assert(static_cast<int>(Opcode::AccessProperty) -
+                  static_cast<int>(Opcode::Add) ==
+              static_cast<int>(OperatorType::AccessProperty));
+
+inline Opcode opcodeFor(OperatorType type) {
+  return static_cast<Opcode>(static_cast<int>(Opcode::Add) +
+                             static_cast<int>(type));
+}
+
+inline OperatorType operatorFor(Opcode opcode) {
+  return static_cast<OperatorType>(static_cast<int>(opcode) -
+                                   static_cast<int>(Opcode::Add));
+}
+
+struct Chunk {
+  std::vector<uint8_t> code;
+  std::vector<Value> constants;
+  std::vector<SymbolId> symbols;
+  // Most values the chunk keeps on the stack at once, from the stack effect
+  // of every instruction along every path (Expression::stackBound)
+  size_t maxDepth = 0;
+};
+
+inline void writeVarint(std::vector<uint8_t>& code, uint64_t value) {
+  for (; value >= 0x80; value >>= 7) {
+    code.push_back(static_cast<uint8_t>(value | 0x80));
+  }
+  code.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t readVarint(const uint8_t*& ip) {
+  uint64_t value = *ip++;
+  if (value < 0x80) {
+    return value;
+  }
+  value &= 0x7f;
+  for (unsigned shift = 7;; shift += 7) {
+    uint8_t byte = *ip++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      return value;
+    }
+  }
+}
+
+inline uint32_t readTarget(const uint8_t*& ip) {
+  uint32_t target;
+  std::memcpy(&target, ip, sizeof(target));
+  ip += sizeof(target);
+  return target;
+}
+
 class Node {
  public:
   virtual ~Node() {}
@@ -101,506 +441,1161 @@ class Node {
 class Expression : public Node {
  public:
   std::vector<Token> tokens;
+  bool linked = false;
+  // Variable of every frame slot of a resolved function body, in slot order:
+  // a read past an unset slot looks the name up in enclosing frames
+  std::vector<SymbolId> slotNames;
+
+  // Finalizes the expression: If/Else/EndIf/While/EndWhile are replaced by
+  // JumpIfFalse/Jump/JumpIfTrue to absolute offsets, so a branch costs one
+  // step whatever the size of the body it skips. EndIf and While only mark a
+  // position and are dropped. On unbalanced control flow the tokens are left
+  // as they are and false is returned.
+  bool link() {
+    if (linked) {
+      return true;
+    }
+    const size_t count = tokens.size();
+    // Matching token: Else or EndIf for an If, EndIf for an Else, While for
+    // an EndWhile
+    std::vector<size_t> match(count);
+    std::vector<size_t> open;
+    auto controlFlow = [&](size_t i) -> std::optional<ControlFlowType> {
+      if (tokens[i].type != TokenType::ControlFlow) {
+        return std::nullopt;
+      }
+      return std::get<ControlFlowType>(tokens[i].value);
+    };
+    for (size_t i = 0; i < count; ++i) {
+      std::optional<ControlFlowType> type = controlFlow(i);
+      if (type == ControlFlowType::If || type == ControlFlowType::While) {
+        open.push_back(i);
+      } else if (type == ControlFlowType::Else) {
+        if (open.empty() || controlFlow(open.back()) != ControlFlowType::If) {
+          std::cerr << "Else without matching If." << std::endl;
+          return false;
+        }
+        match[open.back()] = i;
+        open.back() = i;
+      } else if (type == ControlFlowType::EndIf) {
+        if (open.empty() || controlFlow(open.back()) == ControlFlowType::While) {
+          std::cerr << "EndIf without matching If." << std::endl;
+          return false;
+        }
+        match[open.back()] = i;
+        open.pop_back();
+      } else if (type == ControlFlowType::EndWhile) {
+        if (open.empty() || controlFlow(open.back()) != ControlFlowType::While) {
+          std::cerr << "EndWhile without matching While." << std::endl;
+          return false;
+        }
+        match[i] = open.back();
+        open.pop_back();
+      }
+    }
+    if (!open.empty()) {
+      std::cerr << "Unterminated If or While." << std::endl;
+      return false;
+    }
+
+    // Offset of every token once the markers are dropped; a marker gets the
+    // offset of the token that follows it
+    std::vector<size_t> offsets(count);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+      offsets[i] = kept;
+      std::optional<ControlFlowType> type = controlFlow(i);
+      if (type != ControlFlowType::EndIf && type != ControlFlowType::While) {
+        ++kept;
+      }
+    }
+
+    std::vector<Token> linkedTokens;
+    linkedTokens.reserve(kept);
+    for (size_t i = 0; i < count; ++i) {
+      std::optional<ControlFlowType> type = controlFlow(i);
+      if (type == ControlFlowType::If) {
+        // A false condition continues after the Else, or at the EndIf
+        size_t target = offsets[match[i]];
+        if (controlFlow(match[i]) == ControlFlowType::Else) {
+          ++target;
+        }
+        linkedTokens.push_back({TokenType::JumpIfFalse, Target{target}});
+      } else if (type == ControlFlowType::Else) {
+        linkedTokens.push_back({TokenType::Jump, Target{offsets[match[i]]}});
+      } else if (type == ControlFlowType::EndWhile) {
+        linkedTokens.push_back(
+            {TokenType::JumpIfTrue, Target{offsets[match[i]]}});
+      } else if (type != ControlFlowType::EndIf &&
+                 type != ControlFlowType::While) {
+        linkedTokens.push_back(std::move(tokens[i]));
+      }
+    }
+    tokens = std::move(linkedTokens);
+    linked = true;
+    return true;
+  }
+
+  // Bytecode of the expression, compiled on the first call and linked
+  // first if needed; nullptr if the expression is malformed
+  const Chunk* compile();
+
+ private:
+  std::unique_ptr<Chunk> bytecode_;
+
+  std::optional<size_t> stackBound() const;
 };
 
+inline const Chunk* Expression::compile() {
+  if (bytecode_) {
+    return bytecode_.get();
+  }
+  if (!link()) {
+    return nullptr;
+  }
+  auto chunk = std::make_unique<Chunk>();
+  std::vector<uint8_t>& code = chunk->code;
+  std::unordered_map<SymbolId, size_t> symbols;
+  auto writeSymbol = [&](SymbolId id) {
+    auto [it, added] = symbols.emplace(id, chunk->symbols.size());
+    if (added) {
+      chunk->symbols.push_back(id);
+    }
+    writeVarint(code, it->second);
+  };
+  auto writeSlot = [&](Opcode local, Opcode outer, const Slot& slot) {
+    if (slot.depth == 0) {
+      code.push_back(static_cast<uint8_t>(local));
+    } else {
+      code.push_back(static_cast<uint8_t>(outer));
+      writeVarint(code, slot.depth);
+    }
+    writeVarint(code, slot.index);
+    // Without an active frame of the enclosing function the read goes by name
+    if (outer == Opcode::LoadOuter && slot.depth != 0) {
+      writeSymbol(slot.name);
+    }
+  };
+  // Byte offset of every token, for the jumps; the last entry is the final
+  // Return
+  std::vector<uint32_t> offsets(tokens.size() + 1);
+  // Position of the target operand and target token of every jump
+  std::vector<std::pair<size_t, size_t>> jumps;
+
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    offsets[i] = static_cast<uint32_t>(code.size());
+    const Token& token = tokens[i];
+    switch (token.type) {
+      case TokenType::Operand:
+        code.push_back(static_cast<uint8_t>(Opcode::Constant));
+        writeVarint(code, chunk->constants.size());
+        chunk->constants.push_back(std::get<Value>(token.value));
+        break;
+      case TokenType::Variable:
+        code.push_back(static_cast<uint8_t>(Opcode::LoadName));
+        writeSymbol(std::get<SymbolId>(token.value));
+        break;
+      case TokenType::LoadLocal:
+        writeSlot(Opcode::LoadLocal, Opcode::LoadOuter,
+                  std::get<Slot>(token.value));
+        break;
+      case TokenType::StoreLocal:
+        writeSlot(Opcode::StoreLocal, Opcode::StoreOuter,
+                  std::get<Slot>(token.value));
+        break;
+      case TokenType::LoadGlobal:
+      case TokenType::StoreGlobal:
+        code.push_back(static_cast<uint8_t>(token.type == TokenType::LoadGlobal
+                                                ? Opcode::LoadGlobal
+                                                : Opcode::StoreGlobal));
+        writeSymbol(std::get<Slot>(token.value).index);
+        break;
+      case TokenType::Operator:
+        code.push_back(static_cast<uint8_t>(
+            opcodeFor(std::get<OperatorType>(token.value))));
+        break;
+      case TokenType::Call:
+        code.push_back(static_cast<uint8_t>(Opcode::Call));
+        writeVarint(code, std::get<Arity>(token.value).count);
+        break;
+      case TokenType::Jump:
+      case TokenType::JumpIfFalse:
+      case TokenType::JumpIfTrue:
+        code.push_back(static_cast<uint8_t>(
+            token.type == TokenType::Jump          ? Opcode::Jump
+            : token.type == TokenType::JumpIfFalse ? Opcode::JumpIfFalse
+                                                   : Opcode::JumpIfTrue));
+        jumps.emplace_back(code.size(), std::get<Target>(token.value).offset);
+        code.resize(code.size() + sizeof(uint32_t));
+        break;
+      case TokenType::ControlFlow:
+        // Only Return is left after linking
+        code.push_back(static_cast<uint8_t>(Opcode::Return));
+        break;
+      default:
+        std::cerr << "Unknown token type." << std::endl;
+        return nullptr;
+    }
+  }
+  offsets.back() = static_cast<uint32_t>(code.size());
+  std::optional<size_t> depth = stackBound();
+  if (!depth) {
+    std::cerr << "Unbalanced stack in expression." << std::endl;
+    return nullptr;
+  }
+  chunk->maxDepth = *depth;
+  code.push_back(static_cast<uint8_t>(Opcode::Return));
+
+  for (const auto& [position, target] : jumps) {
+    std::memcpy(&code[position], &offsets[target], sizeof(uint32_t));
+  }
+  bytecode_ = std::move(chunk);
+  return bytecode_.get();
+}
+
+// Most values the linked tokens keep on the stack at once, following both
+// ways out of every conditional jump; nullopt if two paths reach a token
+// with different depths. An operation on too few operands counts from an
+// empty stack, as its handler either stops the expression or drops what is
+// there.
+inline std::optional<size_t> Expression::stackBound() const {
+  const size_t count = tokens.size();
+  constexpr size_t kUnreached = SIZE_MAX;
+  // Depth before every token; the last entry is the final Return
+  std::vector<size_t> depths(count + 1, kUnreached);
+  std::vector<size_t> pending;
+  auto reach = [&](size_t i, size_t depth) {
+    if (depths[i] == kUnreached) {
+      depths[i] = depth;
+      pending.push_back(i);
+    }
+    return depths[i] == depth;
+  };
+  reach(0, 0);
+  size_t bound = 0;
+  while (!pending.empty()) {
+    const size_t i = pending.back();
+    pending.pop_back();
+    if (i == count) {
+      continue;
+    }
+    const Token& token = tokens[i];
+    size_t pops = 0;
+    size_t pushes = 0;
+    switch (token.type) {
+      case TokenType::Operand:
+      case TokenType::Variable:
+      case TokenType::LoadLocal:
+      case TokenType::LoadGlobal:
+        pushes = 1;
+        break;
+      case TokenType::StoreLocal:
+      case TokenType::StoreGlobal:
+      case TokenType::JumpIfFalse:
+      case TokenType::JumpIfTrue:
+        pops = 1;
+        break;
+      case TokenType::Call:
+        pops = std::get<Arity>(token.value).count + size_t{1};
+        pushes = 1;
+        break;
+      case TokenType::Operator:
+        switch (std::get<OperatorType>(token.value)) {
+          case OperatorType::Negate:
+          case OperatorType::LogicalNot:
+            pops = 1;
+            pushes = 1;
+            break;
+          case OperatorType::Duplicate:
+            pops = 1;
+            pushes = 2;
+            break;
+          case OperatorType::Pop:
+            pops = 1;
+            break;
+          case OperatorType::Assign:
+            pops = 2;
+            break;
+          default:
+            pops = 2;
+            pushes = 1;
+        }
+        break;
+      default:
+        break;
+    }
+    const size_t depth = depths[i] - std::min(depths[i], pops) + pushes;
+    bound = std::max(bound, depth);
+
+    if (token.type == TokenType::ControlFlow) {
+      continue;  // Return
+    }
+    if (token.type == TokenType::Jump ||
+        token.type == TokenType::JumpIfFalse ||
+        token.type == TokenType::JumpIfTrue) {
+      if (!reach(std::get<Target>(token.value).offset, depth)) {
+        return std::nullopt;
+      }
+    }
+    if (token.type != TokenType::Jump && !reach(i + 1, depth)) {
+      return std::nullopt;
+    }
+  }
+  return bound;
+}
+
 class Context {
  private:
   Context* parentContext_;
-  std::unordered_map<std::string, std::shared_ptr<ElgObject>> variables_;
+  // Variables of a nested context (functions of hand-built programs)
+  std::unordered_map<SymbolId, Value> variables_;
+  // The global context keeps a slot per SymbolId instead, so resolved code
+  // reaches a global by index (LoadGlobal/StoreGlobal); unbound slots are
+  // Undefined
+  std::vector<Value> globals_;
   std::optional<ElgObject> returnValue_;
 
  public:
   Context(Context* parentContext = nullptr) : parentContext_(parentContext) {}
 
-  void setVariable(const std::string& name,
-                   const std::shared_ptr<ElgObject>& object) {
-    variables_[name] = object;
+  void setVariable(SymbolId name, Value value) {
+    if (!parentContext_) {
+      global(name) = std::move(value);
+      return;
+    }
+    variables_[name] = std::move(value);
   }
 
-  std::shared_ptr<ElgObject> getVariable(const std::string& name) {
+  // Undefined if the name is not bound in this or any enclosing context
+  Value getVariable(SymbolId name) {
+    if (!parentContext_) {
+      return name < globals_.size() ? globals_[name] : Value();
+    }
     auto it = variables_.find(name);
     if (it != variables_.end()) {
       return it->second;
-    } else if (parentContext_) {
-      return parentContext_->getVariable(name);
-    } else {
-      return std::make_shared<ElgObject>(
-          std::make_shared<ElgPrimitive>(ElgPrimitive::Undefined()));
     }
+    return parentContext_->getVariable(name);
+  }
+
+  // Slot of a global; only for the global context
+  Value& global(SymbolId name) {
+    if (name >= globals_.size()) {
+      globals_.resize(name + 1);
+    }
+    return globals_[name];
   }
 
   void setReturnValue(const ElgObject& object) { returnValue_ = object; }
   std::optional<ElgObject> getReturnValue() { return returnValue_; }
 };
 
+// Operand stack of the Interpreter: one block of Values with raw storage
+// above the top, so the running chunk keeps the top in a local pointer and
+// pushes without checks. A chunk reserves room for its maximum depth on
+// entry; growing moves the block, so pointers into it are reloaded after
+// every call.
+class ValueStack {
+ public:
+  ValueStack() = default;
+  ValueStack(const ValueStack&) = delete;
+  ValueStack& operator=(const ValueStack&) = delete;
+  ~ValueStack() {
+    truncate(0);
+    ::operator delete(data_);
+  }
+
+  size_t size() const { return static_cast<size_t>(top_ - data_); }
+  Value* data() { return data_; }
+  Value* top() { return top_; }
+  Value& operator[](size_t index) { return data_[index]; }
+
+  // Values below top must be constructed, the ones from top up are not
+  void setTop(Value* top) { top_ = top; }
+
+  // Room for count more values above the top
+  void reserve(size_t count) {
+    if (static_cast<size_t>(end_ - top_) < count) {
+      grow(size() + count);
+    }
+  }
+
+  void push(Value value) {
+    reserve(1);
+    new (top_++) Value(std::move(value));
+  }
+
+  // Drops values above size, or pads with Undefined up to it
+  void resize(size_t size) {
+    if (size < this->size()) {
+      truncate(size);
+      return;
+    }
+    reserve(size - this->size());
+    while (top_ < data_ + size) {
+      new (top_++) Value();
+    }
+  }
+
+  void truncate(size_t size) {
+    while (top_ > data_ + size) {
+      (--top_)->~Value();
+    }
+  }
+
+ private:
+  Value* data_ = nullptr;
+  Value* top_ = nullptr;
+  Value* end_ = nullptr;
+
+  void grow(size_t needed) {
+    size_t capacity = std::max<size_t>(needed, 2 * (end_ - data_));
+    capacity = std::max<size_t>(capacity, 256);
+    Value* data =
+        static_cast<Value*>(::operator new(capacity * sizeof(Value)));
+    Value* top = data;
+    for (Value* value = data_; value < top_; ++value, ++top) {
+      new (top) Value(std::move(*value));
+      value->~Value();
+    }
+    ::operator delete(data_);
+    data_ = data;
+    top_ = top;
+    end_ = data + capacity;
+  }
+};
+
+// Int arithmetic wraps around modulo 2^64 instead of overflowing: the
+// operations go through uint64_t, where overflow is defined. INT64_MIN / -1
+// is INT64_MIN and INT64_MIN % -1 is 0, which the hardware division would
+// trap on; a zero divisor is the caller's to rule out.
+inline int64_t wrapAdd(int64_t l, int64_t r) {
+  return static_cast<int64_t>(static_cast<uint64_t>(l) +
+                              static_cast<uint64_t>(r));
+}
+
+inline int64_t wrapSubtract(int64_t l, int64_t r) {
+  return static_cast<int64_t>(static_cast<uint64_t>(l) -
+                              static_cast<uint64_t>(r));
+}
+
+inline int64_t wrapMultiply(int64_t l, int64_t r) {
+  return static_cast<int64_t>(static_cast<uint64_t>(l) *
+                              static_cast<uint64_t>(r));
+}
+
+inline int64_t wrapNegate(int64_t value) {
+  return static_cast<int64_t>(0 - static_cast<uint64_t>(value));
+}
+
+inline int64_t wrapDivide(int64_t l, int64_t r) {
+  return r == -1 ? wrapNegate(l) : l / r;
+}
+
+inline int64_t wrapModulo(int64_t l, int64_t r) {
+  return r == -1 ? 0 : l % r;
+}
+
+// The interpreter loop dispatches through a table of label addresses (the
+// GCC and Clang labels-as-values extension): every handler ends in its own
+// indirect jump, which the branch predictor learns per opcode, instead of
+// all opcodes sharing the jump of one switch. ELANG_RPN_SWITCH_DISPATCH, or
+// another compiler, selects the portable switch loop.
+#if defined(__GNUC__) && !defined(ELANG_RPN_SWITCH_DISPATCH)
+#define ELANG_RPN_THREADED_DISPATCH 1
+#else
+#define ELANG_RPN_THREADED_DISPATCH 0
+#endif
+
 class Interpreter {
  public:
   Interpreter(Context* globalContext) : globalContext_(globalContext) {
     initBuiltInFunctions();
   }
 
-  std::shared_ptr<ElgObject> evaluateExpression(Expression* expr,
-                                                Context* context) {
-    std::vector<std::shared_ptr<ElgObject>> stack;
+  // Value left on top of the stack, or nothing after an error or when the
+  // expression leaves the stack empty
+  std::optional<Value> evaluateExpression(Expression* expr, Context* context) {
+    ValueStack stack;
     return evaluateExpression(expr, context, stack);
   }
 
  private:
   Context* globalContext_;
-  std::unordered_map<std::string, std::shared_ptr<ElgObject>> builtInFunctions_;
+  std::unordered_map<std::string, Value> builtInFunctions_;
+
+  // Active call of a resolved function. Its slots are on the operand stack
+  // from locals; staticLink is the frame of the enclosing function, whose
+  // slots the body reaches with depth 1, or kNoFrame.
+  struct Frame {
+    size_t locals;
+    const Expression* code;
+    size_t staticLink;
+  };
+  static constexpr size_t kNoFrame = SIZE_MAX;
+  std::vector<Frame> frames_;
 
   void initBuiltInFunctions() {
-    builtInFunctions_["print"] =
-        std::make_shared<ElgObject>(std::make_shared<ElgPrimitive>("print"));
-  }
-
-  std::shared_ptr<ElgObject> evaluateExpression(
-      Expression* expr, Context* context,
-      std::vector<std::shared_ptr<ElgObject>>& stack) {
-    size_t i = 0;
-    std::vector<size_t> loopStack;
-
-    while (i < expr->tokens.size()) {
-      const Token& token = expr->tokens[i];
-      switch (token.type) {
-        case TokenType::Operand: {
-          ElgObject operand = std::get<ElgObject>(token.value);
-          stack.push_back(std::make_shared<ElgObject>(operand));
-          break;
+    // A built-in is a string value naming it; Call dispatches on it
+    builtInFunctions_["print"] = Value(std::string("print"));
+    // Built-ins are globals, so generated code calls them like any function
+    for (const auto& [name, function] : builtInFunctions_) {
+      globalContext_->setVariable(symbol(name), function);
+    }
+  }
+
+  // Runs expr on top of the caller's stack: a function call reuses the same
+  // stack, and whatever the callee leaves above its base is dropped. Local
+  // slots of a resolved function start at stack[locals].
+  std::optional<Value> evaluateExpression(Expression* expr, Context* context,
+                                          ValueStack& stack,
+                                          size_t locals = 0) {
+    const Chunk* chunk = expr->compile();
+    if (!chunk) {
+      return std::nullopt;
+    }
+    return execute(*chunk, context, stack, locals);
+  }
+
+  // Handlers are written once for both dispatch modes: a label and a jump
+  // through kHandlers, or a case of the switch loop. A computed goto does not
+  // run destructors, so a handler with Value locals closes its block before
+  // ELANG_RPN_NEXT.
+#if ELANG_RPN_THREADED_DISPATCH
+#define ELANG_RPN_CASE(name) op_##name
+#define ELANG_RPN_NEXT()                            \
+  do {                                              \
+    opcode = static_cast<Opcode>(*ip++);            \
+    goto *kHandlers[static_cast<uint8_t>(opcode)];  \
+  } while (0)
+#else
+#define ELANG_RPN_CASE(name) case Opcode::name
+#define ELANG_RPN_NEXT() break
+#endif
+
+  std::optional<Value> execute(const Chunk& chunk, Context* context,
+                               ValueStack& stack, size_t locals) {
+    stack.reserve(chunk.maxDepth);
+    const size_t base = stack.size();
+    // sp is the first free slot, kept in a local rather than in the stack;
+    // bottom and slots move with the stack
+    Value* sp = stack.top();
+    Value* bottom = sp;
+    Value* slots = stack.data() + locals;
+    const uint8_t* const code = chunk.code.data();
+    const uint8_t* ip = code;
+
+#if ELANG_RPN_THREADED_DISPATCH
+    // Handler of every opcode, in Opcode order
+    static const void* const kHandlers[] = {
+        &&op_Constant, &&op_LoadName, &&op_LoadLocal, &&op_StoreLocal,
+        &&op_LoadOuter, &&op_StoreOuter, &&op_LoadGlobal, &&op_StoreGlobal,
+        &&op_Add, &&op_Subtract, &&op_Multiply, &&op_Divide, &&op_Modulo,
+        &&op_Equal, &&op_NotEqual, &&op_LessThan, &&op_GreaterThan,
+        &&op_LessEqual, &&op_GreaterEqual, &&op_LogicalAnd, &&op_LogicalOr,
+        &&op_Negate, &&op_LogicalNot, &&op_Duplicate, &&op_Pop, &&op_Assign,
+        &&op_AccessProperty, &&op_Call, &&op_Jump, &&op_JumpIfFalse,
+        &&op_JumpIfTrue, &&op_Return,
+    };
+    static_assert(std::size(kHandlers) ==
+                  static_cast<size_t>(Opcode::Return) + 1);
+    Opcode opcode;
+    ELANG_RPN_NEXT();
+#else
+    for (;;) {
+      const Opcode opcode = static_cast<Opcode>(*ip++);
+      switch (opcode) {
+#endif
+        ELANG_RPN_CASE(Constant):
+          new (sp++) Value(chunk.constants[readVarint(ip)]);
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(LoadName):
+          new (sp++)
+              Value(context->getVariable(chunk.symbols[readVarint(ip)]));
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(LoadLocal): {
+          size_t index = readVarint(ip);
+          if (slots[index].isUnset()) {
+            new (sp++) Value(outerBinding(stack, frames_.size() - 1, index));
+          } else {
+            new (sp++) Value(slots[index]);
+          }
+          ELANG_RPN_NEXT();
         }
-        case TokenType::Variable: {
-          std::string varName = std::get<std::string>(token.value);
-          auto varObj = context->getVariable(varName);
-          stack.push_back(varObj);
-          break;
+        ELANG_RPN_CASE(StoreLocal): {
+          Value& target = slots[readVarint(ip)];
+          if (sp == bottom) {
+            return underflow(stack, sp, base,
+                             "Not enough operands for assignment.");
+          }
+          // The old value is released with the popped slot
+          target.swap(*--sp);
+          sp->~Value();
+          ELANG_RPN_NEXT();
         }
-        case TokenType::Operator: {
-          OperatorType opType = std::get<OperatorType>(token.value);
-          if (opType == OperatorType::Assign) {
-            if (stack.size() < 2) {
-              std::cerr << "Not enough operands for assignment." << std::endl;
-              return nullptr;
-            }
-            auto valueObj = stack.back();
-            stack.pop_back();
-            auto varNameObj = stack.back();
-            stack.pop_back();
-            // printValue(varNameObj);
-            // printValue(valueObj);
-            // std::cout << *valueObj << std::endl;
-            // std::cout << "Set variable <" << varNameStr << "> with value ***"
-            //           << std::endl;
-
-            auto varNamePrimitive =
-                std::get<std::shared_ptr<ElgPrimitive>>(varNameObj->value);
-            if (auto varNameStr =
-                    std::get_if<std::string>(&varNamePrimitive->value)) {
-              context->setVariable(*varNameStr, valueObj);
-              std::cout << "Assigned value" << std::endl;
-            } else {
-              std::cerr << "Invalid variable name for assignment." << std::endl;
-              return nullptr;
+        ELANG_RPN_CASE(LoadOuter): {
+          size_t frame = enclosingFrame(static_cast<uint32_t>(readVarint(ip)));
+          size_t index = readVarint(ip);
+          SymbolId name = chunk.symbols[readVarint(ip)];
+          if (frame == kNoFrame) {
+            new (sp++) Value(globalContext_->getVariable(name));
+          } else if (stack[frames_[frame].locals + index].isUnset()) {
+            new (sp++) Value(outerBinding(stack, frame, index));
+          } else {
+            new (sp++) Value(stack[frames_[frame].locals + index]);
+          }
+          ELANG_RPN_NEXT();
+        }
+        ELANG_RPN_CASE(StoreOuter): {
+          size_t frame = enclosingFrame(static_cast<uint32_t>(readVarint(ip)));
+          size_t index = readVarint(ip);
+          if (sp == bottom) {
+            return underflow(stack, sp, base,
+                             "Not enough operands for assignment.");
+          }
+          --sp;
+          if (frame != kNoFrame) {
+            stack[frames_[frame].locals + index].swap(*sp);
+          }
+          sp->~Value();
+          ELANG_RPN_NEXT();
+        }
+        ELANG_RPN_CASE(LoadGlobal):
+          new (sp++) Value(
+              globalContext_->getVariable(chunk.symbols[readVarint(ip)]));
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(StoreGlobal): {
+          SymbolId name = chunk.symbols[readVarint(ip)];
+          if (sp == bottom) {
+            return underflow(stack, sp, base,
+                             "Not enough operands for assignment.");
+          }
+          globalContext_->global(name).swap(*--sp);
+          sp->~Value();
+          ELANG_RPN_NEXT();
+        }
+        ELANG_RPN_CASE(Add):
+          sp = binary(sp, bottom, OperatorType::Add,
+                      [](int64_t l, int64_t r) { return wrapAdd(l, r); });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Subtract):
+          sp = binary(sp, bottom, OperatorType::Subtract,
+                      [](int64_t l, int64_t r) { return wrapSubtract(l, r); });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Multiply):
+          sp = binary(sp, bottom, OperatorType::Multiply,
+                      [](int64_t l, int64_t r) { return wrapMultiply(l, r); });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Divide):
+          sp = binary(sp, bottom, OperatorType::Divide,
+                      [](int64_t l, int64_t r) { return wrapDivide(l, r); });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Modulo):
+          sp = binary(sp, bottom, OperatorType::Modulo,
+                      [](int64_t l, int64_t r) { return wrapModulo(l, r); });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Equal):
+          sp = binary(sp, bottom, OperatorType::Equal,
+                      [](int64_t l, int64_t r) { return int64_t{l == r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(NotEqual):
+          sp = binary(sp, bottom, OperatorType::NotEqual,
+                      [](int64_t l, int64_t r) { return int64_t{l != r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(LessThan):
+          sp = binary(sp, bottom, OperatorType::LessThan,
+                      [](int64_t l, int64_t r) { return int64_t{l < r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(GreaterThan):
+          sp = binary(sp, bottom, OperatorType::GreaterThan,
+                      [](int64_t l, int64_t r) { return int64_t{l > r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(LessEqual):
+          sp = binary(sp, bottom, OperatorType::LessEqual,
+                      [](int64_t l, int64_t r) { return int64_t{l <= r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(GreaterEqual):
+          sp = binary(sp, bottom, OperatorType::GreaterEqual,
+                      [](int64_t l, int64_t r) { return int64_t{l >= r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(LogicalAnd):
+          sp = binary(sp, bottom, OperatorType::LogicalAnd,
+                      [](int64_t l, int64_t r) { return int64_t{l && r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(LogicalOr):
+          sp = binary(sp, bottom, OperatorType::LogicalOr,
+                      [](int64_t l, int64_t r) { return int64_t{l || r}; });
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Negate):
+        ELANG_RPN_CASE(LogicalNot):
+          if (sp == bottom) {
+            report("Not enough operands on the stack for unary operator.");
+            new (sp++) Value();
+            ELANG_RPN_NEXT();
+          }
+          sp = applySlow(sp, operatorFor(opcode), 1);
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Duplicate):
+          if (sp == bottom) {
+            report("Not enough operands on the stack for unary operator.");
+            new (sp++) Value();
+          } else {
+            new (sp) Value(sp[-1]);
+            ++sp;
+          }
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Pop):
+          if (sp > bottom) {
+            (--sp)->~Value();
+          }
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Assign):
+          if (sp - bottom < 2) {
+            return underflow(stack, sp, base,
+                             "Not enough operands for assignment.");
+          }
+          sp -= 2;
+          if (!assign(sp, context)) {
+            return fail(stack, sp, base);
+          }
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(AccessProperty): {
+          if (sp - bottom < 2) {
+            return underflow(stack, sp, base,
+                             "Not enough operands for property access.");
+          }
+          sp -= 2;
+          std::optional<Value> property = accessProperty(sp);
+          if (!property) {
+            return fail(stack, sp, base);
+          }
+          new (sp++) Value(std::move(*property));
+        }
+        ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Call): {
+          // The callee and its arguments give way to exactly one result
+          size_t argc = readVarint(ip);
+          if (static_cast<size_t>(sp - bottom) <= argc) {
+            return underflow(stack, sp, base,
+                             "Stack underflow: not enough values for call.");
+          }
+          Value function = std::move(*--sp);
+          sp->~Value();
+          Value* args = sp - argc;
+
+          if (function.tag() == Value::Tag::String &&
+              function.asString() == "print") {
+            for (Value* arg = args; arg < sp; ++arg) {
+              printValue(*arg);
             }
-          } else if (opType == OperatorType::AccessProperty) {
-            if (stack.size() < 2) {
-              std::cerr << "Not enough operands for property access."
+          } else if (function.tag() == Value::Tag::String) {
+            // Try to get function from context (for recursion)
+            Value named = context->getVariable(symbol(function.asString()));
+            if (named.tag() != Value::Tag::Function) {
+              std::cerr << "Unknown function: " << function.asString()
                         << std::endl;
-              return nullptr;
-            }
-            auto propertyNameObj = stack.back();
-            stack.pop_back();
-            auto objectObj = stack.back();
-            stack.pop_back();
-
-            auto propertyNamePrimitive =
-                std::get<std::shared_ptr<ElgPrimitive>>(propertyNameObj->value);
-            if (auto propertyNameStr =
-                    std::get_if<std::string>(&propertyNamePrimitive->value)) {
-              auto objectValue = objectObj->value;
-              if (auto objectMap = std::get_if<std::unordered_map<
-                      std::string, std::shared_ptr<ElgObject>>>(&objectValue)) {
-                auto it = objectMap->find(*propertyNameStr);
-                if (it != objectMap->end()) {
-                  stack.push_back(it->second);
-                } else {
-                  // Return undefined object when property not found
-                  stack.push_back(std::make_shared<ElgObject>(
-                      std::make_shared<ElgPrimitive>(
-                          ElgPrimitive::Undefined())));
-                }
-              } else {
-                // Return undefined object when accessing property of non-object
-                stack.push_back(std::make_shared<ElgObject>(
-                    std::make_shared<ElgPrimitive>(ElgPrimitive::Undefined())));
-              }
-            } else {
-              std::cerr << "Invalid property name for access." << std::endl;
-              return nullptr;
-            }
-          } else if (opType == OperatorType::FunctionCall) {
-            if (stack.empty()) {
-              std::cerr << "Stack underflow: no function to call." << std::endl;
-              return nullptr;
-            }
-            auto functionObj = stack.back();
-            stack.pop_back();
-
-            auto functionPrimitive =
-                std::get<std::shared_ptr<ElgPrimitive>>(functionObj->value);
-
-            if (std::holds_alternative<ElgPrimitive::Function>(
-                    functionPrimitive->value)) {
-              auto function =
-                  std::get<ElgPrimitive::Function>(functionPrimitive->value);
-              auto result = callFunction(function, stack, context);
-              if (result) {
-                stack.push_back(result);
-              }
-            } else if (auto funcName = std::get_if<std::string>(
-                           &functionPrimitive->value)) {
-              // Handle built-in functions
-              if (*funcName == "print") {
-                if (stack.empty()) {
-                  std::cerr << "Stack underflow: no value to print."
-                            << std::endl;
-                  return nullptr;
-                }
-                auto valueObj = stack.back();
-                stack.pop_back();
-                printValue(valueObj);
-                // Optionally push undefined or the printed value onto the stack
-                // stack.push_back(std::make_shared<ElgObject>(
-                //     std::make_shared<ElgPrimitive>(ElgPrimitive::Undefined())));
-              } else {
-                // Try to get function from context (for recursion)
-                auto funcObj = context->getVariable(*funcName);
-                auto funcPrimitive =
-                    std::get<std::shared_ptr<ElgPrimitive>>(funcObj->value);
-                if (std::holds_alternative<ElgPrimitive::Function>(
-                        funcPrimitive->value)) {
-                  // Push back function and call it
-                  stack.push_back(funcObj);
-                  // Since we already popped arguments earlier, we need to
-                  // adjust the stack
-                  auto result = callFunction(
-                      std::get<ElgPrimitive::Function>(funcPrimitive->value),
-                      stack, context);
-                  if (result) {
-                    stack.push_back(result);
-                  }
-                } else {
-                  std::cerr << "Unknown function: " << *funcName << std::endl;
-                  return nullptr;
-                }
-              }
-            } else {
-              // Return undefined if trying to call a non-function
-              stack.push_back(std::make_shared<ElgObject>(
-                  std::make_shared<ElgPrimitive>(ElgPrimitive::Undefined())));
+              return fail(stack, sp, base);
             }
+            function = std::move(named);
+          }
+          if (function.tag() == Value::Tag::Function) {
+            // The callee works on the shared stack and may move it
+            stack.setTop(sp);
+            Value result = callFunction(function, argc, stack, context);
+            stack.push(std::move(result));
+            sp = stack.top();
+            bottom = stack.data() + base;
+            slots = stack.data() + locals;
           } else {
-            auto result = applyOperator(opType, stack);
-            if (result) {
-              stack.push_back(result);
-            } else {
-              // If operation fails due to Undefined operands, push Undefined
-              stack.push_back(std::make_shared<ElgObject>(
-                  std::make_shared<ElgPrimitive>(ElgPrimitive::Undefined())));
+            // print, and calls of anything that is not a function, give
+            // undefined
+            while (sp > args) {
+              (--sp)->~Value();
             }
+            new (sp++) Value();
           }
-          break;
         }
-        // case TokenType::Function: {
-        //   break;
-        // }
-        case TokenType::ControlFlow: {
-          // Control flow handling remains the same
-          ControlFlowType cfType = std::get<ControlFlowType>(token.value);
-          if (cfType == ControlFlowType::While) {
-            // Push current position onto loop stack
-            loopStack.push_back(i);
-          } else if (cfType == ControlFlowType::EndWhile) {
-            if (loopStack.empty()) {
-              std::cerr << "EndWhile without matching While." << std::endl;
-              return nullptr;
-            }
-            size_t loopStart = loopStack.back();
-            // Evaluate condition
-            if (stack.empty()) {
-              std::cerr << "Stack underflow in While condition." << std::endl;
-              return nullptr;
-            }
-            auto conditionObj = stack.back();
-            stack.pop_back();
-            bool condition = isTruthy(conditionObj);
-
-            if (condition) {
-              // Jump back to the start of the loop
-              i = loopStart;
-            } else {
-              // Exit loop
-              loopStack.pop_back();
-            }
-          } else if (cfType == ControlFlowType::If) {
-            // Pop condition from the stack
-            if (stack.empty()) {
-              std::cerr << "Stack underflow in If condition." << std::endl;
-              return nullptr;
-            }
-            auto conditionObj = stack.back();
-            stack.pop_back();
-            bool condition = isTruthy(conditionObj);
-
-            if (!condition) {
-              // Skip to Else or EndIf
-              size_t depth = 1;
-              while (depth > 0 && ++i < expr->tokens.size()) {
-                const Token& nextToken = expr->tokens[i];
-                if (nextToken.type == TokenType::ControlFlow) {
-                  ControlFlowType nextCfType =
-                      std::get<ControlFlowType>(nextToken.value);
-                  if (nextCfType == ControlFlowType::If) {
-                    depth++;
-                  } else if (nextCfType == ControlFlowType::EndIf) {
-                    depth--;
-                  } else if (nextCfType == ControlFlowType::Else &&
-                             depth == 1) {
-                    depth--;
-                    break;
-                  }
-                }
-              }
-            }
-          } else if (cfType == ControlFlowType::Else) {
-            // Skip to EndIf
-            size_t depth = 1;
-            while (depth > 0 && ++i < expr->tokens.size()) {
-              const Token& nextToken = expr->tokens[i];
-              if (nextToken.type == TokenType::ControlFlow) {
-                ControlFlowType nextCfType =
-                    std::get<ControlFlowType>(nextToken.value);
-                if (nextCfType == ControlFlowType::If) {
-                  depth++;
-                } else if (nextCfType == ControlFlowType::EndIf) {
-                  depth--;
-                }
-              }
-            }
-          } else if (cfType == ControlFlowType::EndIf) {
-            // Do nothing
+        ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(Jump):
+          ip = code + readTarget(ip);
+          ELANG_RPN_NEXT();
+        ELANG_RPN_CASE(JumpIfFalse):
+        ELANG_RPN_CASE(JumpIfTrue): {
+          uint32_t target = readTarget(ip);
+          if (sp == bottom) {
+            return underflow(stack, sp, base, "Stack underflow in condition.");
+          }
+          bool condition = isTruthy(*--sp);
+          sp->~Value();
+          if (condition == (opcode == Opcode::JumpIfTrue)) {
+            ip = code + target;
           }
-          break;
+          ELANG_RPN_NEXT();
         }
+        ELANG_RPN_CASE(Return):
+          return finish(stack, sp, base);
+#if !ELANG_RPN_THREADED_DISPATCH
         default:
-          std::cerr << "Unknown token type." << std::endl;
-          return nullptr;
+          report("Unknown opcode.");
+          return fail(stack, sp, base);
       }
-      i++;
     }
+#endif
+  }
+
+#undef ELANG_RPN_CASE
+#undef ELANG_RPN_NEXT
 
-    if (!stack.empty()) {
-      return stack.back();
+  std::optional<Value> finish(ValueStack& stack, Value* sp, size_t base) {
+    std::optional<Value> result;
+    if (sp > stack.data() + base) {
+      result = std::move(sp[-1]);
     }
-    return nullptr;
+    stack.setTop(sp);
+    stack.truncate(base);
+    return result;
   }
 
-  bool isTruthy(const std::shared_ptr<ElgObject>& obj) {
-    auto primitive = std::get<std::shared_ptr<ElgPrimitive>>(obj->value);
-    if (auto intVal = std::get_if<int>(&primitive->value)) {
-      return (*intVal != 0);
-    } else if (auto floatVal = std::get_if<float>(&primitive->value)) {
-      return (*floatVal != 0.0f);
-    } else if (auto strVal = std::get_if<std::string>(&primitive->value)) {
-      return (!strVal->empty());
-    } else if (std::holds_alternative<ElgPrimitive::Null>(primitive->value)) {
-      return false;
-    } else if (std::holds_alternative<ElgPrimitive::Undefined>(
-                   primitive->value)) {
-      return false;
-    } else {
+  std::optional<Value> fail(ValueStack& stack, Value* sp, size_t base) {
+    stack.setTop(sp);
+    stack.truncate(base);
+    return std::nullopt;
+  }
+
+  std::optional<Value> underflow(ValueStack& stack, Value* sp, size_t base,
+                                 const char* message) {
+    report(message);
+    return fail(stack, sp, base);
+  }
+
+  // Error output stays out of the interpreter loop
+  static void report(const char* message) { std::cerr << message << std::endl; }
+
+  // Assign and AccessProperty consume the two values at operands; false or
+  // nothing after an error
+  bool assign(Value* operands, Context* context) {
+    Value varName = std::move(operands[0]);
+    Value value = std::move(operands[1]);
+    operands[0].~Value();
+    operands[1].~Value();
+
+    if (varName.tag() != Value::Tag::String) {
+      report("Invalid variable name for assignment.");
       return false;
     }
+    context->setVariable(symbol(varName.asString()), std::move(value));
+    return true;
   }
 
-  std::shared_ptr<ElgObject> applyOperator(
-      OperatorType opType, std::vector<std::shared_ptr<ElgObject>>& stack) {
-    if (opType == OperatorType::Negate || opType == OperatorType::LogicalNot ||
-        opType == OperatorType::Duplicate) {
-      if (stack.empty()) {
-        std::cerr << "Not enough operands on the stack for unary operator."
-                  << std::endl;
-        return nullptr;
-      }
-      auto operand = stack.back();
-      if (opType == OperatorType::Duplicate) {
-        return operand;  // Return the same object to duplicate it on the stack
-      }
-      stack.pop_back();
-      auto operandPrimitive =
-          std::get<std::shared_ptr<ElgPrimitive>>(operand->value);
-
-      if (auto intVal = std::get_if<int>(&operandPrimitive->value)) {
-        int resultValue;
-        if (opType == OperatorType::Negate) {
-          resultValue = -(*intVal);
-        } else if (opType == OperatorType::LogicalNot) {
-          resultValue = !(*intVal);
-        }
-        return std::make_shared<ElgObject>(
-            std::make_shared<ElgPrimitive>(resultValue));
-      } else if (std::holds_alternative<ElgPrimitive::Undefined>(
-                     operandPrimitive->value)) {
-        // Return Undefined if operand is Undefined
-        return std::make_shared<ElgObject>(operandPrimitive);
-      }
-      // Handle other types...
-      std::cerr << "Unsupported operand type for unary operator." << std::endl;
-      return nullptr;
-    } else {
-      if (stack.size() < 2) {
-        std::cerr << "Not enough operands on the stack." << std::endl;
-        return nullptr;
+  std::optional<Value> accessProperty(Value* operands) {
+    Value object = std::move(operands[0]);
+    Value propertyName = std::move(operands[1]);
+    operands[0].~Value();
+    operands[1].~Value();
+
+    if (propertyName.tag() != Value::Tag::String) {
+      report("Invalid property name for access.");
+      return std::nullopt;
+    }
+    // Undefined when the property is missing or the value is not an object
+    Value property;
+    if (object.tag() == Value::Tag::Object) {
+      auto it = object.asObject().find(propertyName.asString());
+      if (it != object.asObject().end()) {
+        property = Value(*it->second);
       }
+    }
+    return property;
+  }
 
-      auto rhs = stack.back();
-      stack.pop_back();
-      auto lhs = stack.back();
-      stack.pop_back();
-
-      auto lhsPrimitive = std::get<std::shared_ptr<ElgPrimitive>>(lhs->value);
-      auto rhsPrimitive = std::get<std::shared_ptr<ElgPrimitive>>(rhs->value);
-
-      // Check if either operand is Undefined
-      if (std::holds_alternative<ElgPrimitive::Undefined>(
-              lhsPrimitive->value) ||
-          std::holds_alternative<ElgPrimitive::Undefined>(
-              rhsPrimitive->value)) {
-        // Return Undefined if any operand is Undefined
-        return std::make_shared<ElgObject>(
-            std::make_shared<ElgPrimitive>(ElgPrimitive::Undefined()));
+  // Replaces the arity operands below sp with the result of applyOperator,
+  // Undefined when the operation fails; returns the new sp
+  Value* applySlow(Value* sp, OperatorType type, size_t arity) {
+    std::optional<Value> result = arity == 1
+                                      ? applyOperator(type, sp[-1])
+                                      : applyOperator(type, sp[-2], sp[-1]);
+    for (size_t i = 0; i < arity; ++i) {
+      (--sp)->~Value();
+    }
+    new (sp++) Value(result ? std::move(*result) : Value());
+    return sp;
+  }
+
+  // Replaces the two operands below sp with the result: in place for two
+  // ints, through applyOperator for anything else and for a division by
+  // zero, which it reports; returns the new sp
+  template <typename F>
+  Value* binary(Value* sp, const Value* bottom, OperatorType type,
+                F intOperation) {
+    if (sp - bottom < 2) {
+      report("Not enough operands on the stack.");
+      while (sp > bottom) {
+        (--sp)->~Value();
       }
+      new (sp++) Value();
+      return sp;
+    }
+    const bool divides =
+        type == OperatorType::Divide || type == OperatorType::Modulo;
+    if (sp[-2].isInt() && sp[-1].isInt() &&
+        !(divides && sp[-1].asInt() == 0)) {
+      int64_t result = intOperation(sp[-2].asInt(), sp[-1].asInt());
+      // Ints own nothing, so both are overwritten without destruction
+      --sp;
+      new (sp - 1) Value(result);
+      return sp;
+    }
+    return applySlow(sp, type, 2);
+  }
 
-      if (auto lhsInt = std::get_if<int>(&lhsPrimitive->value)) {
-        if (auto rhsInt = std::get_if<int>(&rhsPrimitive->value)) {
-          int resultValue;
-          switch (opType) {
-            case OperatorType::Add:
-              resultValue = *lhsInt + *rhsInt;
-              break;
-            case OperatorType::Subtract:
-              resultValue = *lhsInt - *rhsInt;
-              break;
-            case OperatorType::Multiply:
-              resultValue = *lhsInt * *rhsInt;
-              break;
-            case OperatorType::Divide:
-              if (*rhsInt == 0) {
-                std::cerr << "Division by zero." << std::endl;
-                return nullptr;
-              }
-              resultValue = *lhsInt / *rhsInt;
-              break;
-            case OperatorType::GreaterThan:
-              resultValue = *lhsInt > *rhsInt;
-              break;
-            case OperatorType::LessThan:
-              resultValue = *lhsInt < *rhsInt;
-              break;
-            case OperatorType::Equal:
-              resultValue = *lhsInt == *rhsInt;
-              break;
-            case OperatorType::NotEqual:
-              resultValue = *lhsInt != *rhsInt;
-              break;
-            case OperatorType::LessEqual:
-              resultValue = *lhsInt <= *rhsInt;
-              break;
-            case OperatorType::GreaterEqual:
-              resultValue = *lhsInt >= *rhsInt;
-              break;
-            default:
-              std::cerr << "Unsupported operator." << std::endl;
-              return nullptr;
+  bool isTruthy(const Value& value) {
+    switch (value.tag()) {
+      case Value::Tag::Int:
+        return value.asInt() != 0;
+      case Value::Tag::Float:
+        return value.asFloat() != 0.0;
+      case Value::Tag::String:
+        return !value.asString().empty();
+      default:
+        return false;
+    }
+  }
+
+  // Unary operation; nothing if it fails
+  std::optional<Value> applyOperator(OperatorType opType,
+                                     const Value& operand) {
+    if (operand.isInt()) {
+      const int64_t value = operand.asInt();
+      return Value(opType == OperatorType::Negate ? wrapNegate(value)
+                                                  : int64_t{!value});
+    } else if (operand.tag() == Value::Tag::Float) {
+      const double value = operand.asFloat();
+      return opType == OperatorType::Negate ? Value(-value)
+                                            : Value(int64_t{value == 0.0});
+    } else if (operand.isUndefined()) {
+      // Return Undefined if operand is Undefined
+      return operand;
+    }
+    // Handle other types...
+    std::cerr << "Unsupported operand type for unary operator." << std::endl;
+    return std::nullopt;
+  }
+
+  // Binary operation; nothing if it fails
+  std::optional<Value> applyOperator(OperatorType opType, const Value& lhs,
+                                     const Value& rhs) {
+    // Return Undefined if any operand is Undefined
+    if (lhs.isUndefined() || rhs.isUndefined()) {
+      return Value();
+    }
+
+    if (lhs.isInt() && rhs.isInt()) {
+      int64_t l = lhs.asInt();
+      int64_t r = rhs.asInt();
+      switch (opType) {
+        case OperatorType::Add:
+          return Value(wrapAdd(l, r));
+        case OperatorType::Subtract:
+          return Value(wrapSubtract(l, r));
+        case OperatorType::Multiply:
+          return Value(wrapMultiply(l, r));
+        case OperatorType::Divide:
+        case OperatorType::Modulo:
+          if (r == 0) {
+            std::cerr << "Division by zero." << std::endl;
+            return std::nullopt;
           }
-          return std::make_shared<ElgObject>(
-              std::make_shared<ElgPrimitive>(resultValue));
-        }
+          return Value(opType == OperatorType::Divide ? wrapDivide(l, r)
+                                                      : wrapModulo(l, r));
+        case OperatorType::GreaterThan:
+          return Value(int64_t{l > r});
+        case OperatorType::LessThan:
+          return Value(int64_t{l < r});
+        case OperatorType::Equal:
+          return Value(int64_t{l == r});
+        case OperatorType::NotEqual:
+          return Value(int64_t{l != r});
+        case OperatorType::LessEqual:
+          return Value(int64_t{l <= r});
+        case OperatorType::GreaterEqual:
+          return Value(int64_t{l >= r});
+        case OperatorType::LogicalAnd:
+          return Value(int64_t{l && r});
+        case OperatorType::LogicalOr:
+          return Value(int64_t{l || r});
+        default:
+          std::cerr << "Unsupported operator." << std::endl;
+          return std::nullopt;
       }
-      if (auto lhsStr = std::get_if<std::string>(&lhsPrimitive->value)) {
-        if (auto rhsStr = std::get_if<std::string>(&rhsPrimitive->value)) {
-          std::string resultValue;
-          if (opType == OperatorType::Add) {
-            resultValue = *lhsStr + *rhsStr;
-            return std::make_shared<ElgObject>(
-                std::make_shared<ElgPrimitive>(resultValue));
-          }
-          // Handle other string operations...
-        }
+    }
+    // A float with an int or another float: the int is converted, and the
+    // division follows IEEE 754, so a zero divisor gives inf or nan
+    if (lhs.isNumber() && rhs.isNumber()) {
+      double l = lhs.asNumber();
+      double r = rhs.asNumber();
+      switch (opType) {
+        case OperatorType::Add:
+          return Value(l + r);
+        case OperatorType::Subtract:
+          return Value(l - r);
+        case OperatorType::Multiply:
+          return Value(l * r);
+        case OperatorType::Divide:
+          return Value(l / r);
+        case OperatorType::Modulo:
+          return Value(std::fmod(l, r));
+        case OperatorType::GreaterThan:
+          return Value(int64_t{l > r});
+        case OperatorType::LessThan:
+          return Value(int64_t{l < r});
+        case OperatorType::Equal:
+          return Value(int64_t{l == r});
+        case OperatorType::NotEqual:
+          return Value(int64_t{l != r});
+        case OperatorType::LessEqual:
+          return Value(int64_t{l <= r});
+        case OperatorType::GreaterEqual:
+          return Value(int64_t{l >= r});
+        case OperatorType::LogicalAnd:
+          return Value(int64_t{l != 0.0 && r != 0.0});
+        case OperatorType::LogicalOr:
+          return Value(int64_t{l != 0.0 || r != 0.0});
+        default:
+          std::cerr << "Unsupported operator." << std::endl;
+          return std::nullopt;
       }
-
-      // Handle other types (float) similarly...
-      std::cerr << "Type mismatch or unsupported types." << std::endl;
-      return nullptr;
     }
+    if (lhs.tag() == Value::Tag::String && rhs.tag() == Value::Tag::String &&
+        opType == OperatorType::Add) {
+      return Value(lhs.asString() + rhs.asString());
+    }
+
+    std::cerr << "Type mismatch or unsupported types." << std::endl;
+    return std::nullopt;
   }
 
-  std::shared_ptr<ElgObject> callFunction(
-      const ElgPrimitive::Function& function,
-      std::vector<std::shared_ptr<ElgObject>>& stack, Context* parentContext) {
-    // New context
-    Context functionContext(parentContext);
+  // Frame of the function depth levels out from the running one
+  size_t enclosingFrame(uint32_t depth) const {
+    size_t frame = frames_.empty() ? kNoFrame : frames_.size() - 1;
+    for (; depth > 0 && frame != kNoFrame; --depth) {
+      frame = frames_[frame].staticLink;
+    }
+    return frame;
+  }
 
-    if (stack.size() < function.parameters.size()) {
-      std::cerr << "Not enough arguments for function call." << std::endl;
-      return nullptr;
+  // Value a read of the unset slot index of frame sees: the variable of the
+  // same name in the nearest enclosing function that has assigned it, else
+  // the global. A function's own local therefore shadows outer bindings only
+  // from its first assignment on, as with nested Contexts.
+  Value outerBinding(ValueStack& stack, size_t frame, size_t index) {
+    const SymbolId name = frames_[frame].code->slotNames[index];
+    for (frame = frames_[frame].staticLink; frame != kNoFrame;
+         frame = frames_[frame].staticLink) {
+      const std::vector<SymbolId>& names = frames_[frame].code->slotNames;
+      auto it = std::find(names.begin(), names.end(), name);
+      if (it != names.end()) {
+        const Value& outer = stack[frames_[frame].locals + (it - names.begin())];
+        if (!outer.isUnset()) {
+          return outer;
+        }
+      }
     }
+    return globalContext_->getVariable(name);
+  }
 
-    // reverse order on the stack
-    std::vector<std::shared_ptr<ElgObject>> args(function.parameters.size());
-    for (int i = function.parameters.size() - 1; i >= 0; --i) {
-      args[i] = stack.back();
-      stack.pop_back();
+  // Latest active frame of the enclosing function. Anyone who can name a
+  // nested function is inside that function, so the static chain of the
+  // caller leads to it; a function value that escaped is matched with the
+  // latest call of its enclosing function, if any.
+  size_t staticLinkFor(const ElgPrimitive::Function& function) const {
+    if (!function.enclosing) {
+      return kNoFrame;
+    }
+    for (size_t frame = frames_.empty() ? kNoFrame : frames_.size() - 1;
+         frame != kNoFrame; frame = frames_[frame].staticLink) {
+      if (frames_[frame].code == function.enclosing) {
+        return frame;
+      }
+    }
+    for (size_t frame = frames_.size(); frame-- > 0;) {
+      if (frames_[frame].code == function.enclosing) {
+        return frame;
+      }
     }
+    return kNoFrame;
+  }
 
-    for (size_t i = 0; i < function.parameters.size(); ++i) {
-      functionContext.setVariable(function.parameters[i], args[i]);
+  // Arguments are popped from stack; the body runs above them on the same
+  // stack
+  Value callFunction(const Value& callee, size_t argc, ValueStack& stack,
+                     Context* parentContext) {
+    const ElgPrimitive::Function& function = callee.asFunction();
+    // The argc values on top become the parameters: missing ones are
+    // undefined, surplus ones are dropped
+    const size_t first = stack.size() - argc;
+    const size_t params = function.parameters.size();
+    stack.resize(first + params);
+
+    if (function.resolved) {
+      // Arguments become the first slots, locals follow unset
+      const size_t locals = first;
+      stack.resize(locals + function.slots);
+      for (size_t i = locals + params; i < stack.size(); ++i) {
+        stack[i] = Value::unset();
+      }
+      frames_.push_back({locals, function.expression.get(),
+                         staticLinkFor(function)});
+      std::optional<Value> result = evaluateExpression(
+          function.expression.get(), parentContext, stack, locals);
+      frames_.pop_back();
+      stack.resize(locals);
+      return result ? std::move(*result) : Value();
     }
 
-    functionContext.setVariable(
-        function.name,
-        std::make_shared<ElgObject>(std::make_shared<ElgPrimitive>(function)));
+    // New context
+    Context functionContext(parentContext);
 
-    auto result =
-        evaluateExpression(function.expression.get(), &functionContext);
+    // Arguments are on the stack in parameter order
+    for (size_t i = 0; i < params; ++i) {
+      functionContext.setVariable(function.parameters[i],
+                                  std::move(stack[first + i]));
+    }
+    stack.resize(first);
+
+    functionContext.setVariable(function.name, callee);
 
-    return result ? result
-                  : std::make_shared<ElgObject>(std::make_shared<ElgPrimitive>(
-                        ElgPrimitive::Undefined()));
+    return evaluateExpression(function.expression.get(), &functionContext,
+                              stack)
+        .value_or(Value());
   }
 
-  void printValue(const std::shared_ptr<ElgObject>& obj) {
-    auto primitive = std::get<std::shared_ptr<ElgPrimitive>>(obj->value);
-    if (auto intVal = std::get_if<int>(&primitive->value)) {
-      std::cout << *intVal << std::endl;
-    } else if (auto floatVal = std::get_if<float>(&primitive->value)) {
-      std::cout << *floatVal << std::endl;
-    } else if (auto strVal = std::get_if<std::string>(&primitive->value)) {
-      std::cout << *strVal << std::endl;
-    } else if (std::holds_alternative<ElgPrimitive::Null>(primitive->value)) {
-      std::cout << "null" << std::endl;
-    } else if (std::holds_alternative<ElgPrimitive::Undefined>(
-                   primitive->value)) {
-      std::cout << "undefined" << std::endl;
-    } else {
-      std::cout << "[Object object]" << std::endl;
+  void printValue(const Value& value) {
+    switch (value.tag()) {
+      case Value::Tag::Int:
+        std::cout << value.asInt() << std::endl;
+        break;
+      case Value::Tag::Float:
+        std::cout << value.asFloat() << std::endl;
+        break;
+      case Value::Tag::String:
+        std::cout << value.asString() << std::endl;
+        break;
+      case Value::Tag::Null:
+        std::cout << "null" << std::endl;
+        break;
+      case Value::Tag::Undefined:
+        std::cout << "undefined" << std::endl;
+        break;
+      default:
+        std::cout << "[Object object]" << std::endl;
     }
   }
 };
 
 // Global context instance
-Context globalContext;
+inline Context globalContext;
 
-void example() {
+inline void example() {
   Interpreter interpreter(&globalContext);
 
   // Function definition: function factorial(n) { if n <= 1 { 1 } else { n *
@@ -628,9 +1623,9 @@ void example() {
   // print123Function->tokens.push_back(Token{
   //     TokenType::Operand, ElgObject(std::make_shared<ElgPrimitive>("123"))});
   // print123Function->tokens.push_back(
-  //     Token{TokenType::Variable, std::string("print")});
+  //     Token{TokenType::Variable, symbol("print")});
   // print123Function->tokens.push_back(
-  //     Token{TokenType::Operator, OperatorType::FunctionCall});
+  //     Token{TokenType::Call, Arity{1}});
 
   // mainFunction.tokens.push_back(
   //     Token{TokenType::Operand,
@@ -644,13 +1639,13 @@ void example() {
 
 
   // mainFunction.tokens.push_back(
-  //   Token{TokenType::Variable, std::string("print123")}
+  //   Token{TokenType::Variable, symbol("print123")}
   // );
   // mainFunction.tokens.push_back(
-  //   Token{TokenType::Variable, std::string("print")}
+  //   Token{TokenType::Variable, symbol("print")}
   // );
   // mainFunction.tokens.push_back(
-  //   Token{TokenType::Operator, OperatorType::FunctionCall}
+  //   Token{TokenType::Call, Arity{1}}
   // );
   
 
@@ -658,12 +1653,12 @@ void example() {
 
   // Expression printExpr;
   // printExpr.tokens.push_back(
-  //     Token{TokenType::Variable, std::string("testVariable")});
+  //     Token{TokenType::Variable, symbol("testVariable")});
   // printExpr.tokens.push_back(Token{
   //     TokenType::Operand,
   //     ElgObject(std::make_shared<ElgPrimitive>("print"))});
   // printExpr.tokens.push_back(
-  //     Token{TokenType::Operator, OperatorType::FunctionCall});
+  //     Token{TokenType::Call, Arity{1}});
 
   // interpreter.evaluateExpression(&printExpr, &globalContext);
   // Expression funcCallExpr;
@@ -671,9 +1666,9 @@ void example() {
   //     Token{TokenType::Operand,
   //     ElgObject(std::make_shared<ElgPrimitive>(5))});
   // funcCallExpr.tokens.push_back(
-  //     Token{TokenType::Variable, std::string("factorial")});
+  //     Token{TokenType::Variable, symbol("factorial")});
   // funcCallExpr.tokens.push_back(
-  //     Token{TokenType::Operator, OperatorType::FunctionCall});
+  //     Token{TokenType::Call, Arity{1}});
 
   // auto funcCallResult =
   //     interpreter.evaluateExpression(&funcCallExpr, &globalContext);
@@ -694,7 +1689,7 @@ void example() {
   
   auto functionBody = std::make_shared<Expression>();
   // n 1 <= If
-  functionBody->tokens.push_back(Token{TokenType::Variable, std::string("n")});
+  functionBody->tokens.push_back(Token{TokenType::Variable, symbol("n")});
   functionBody->tokens.push_back(
       Token{TokenType::Operand, ElgObject(std::make_shared<ElgPrimitive>(1))});
   functionBody->tokens.push_back(
@@ -707,17 +1702,17 @@ void example() {
   functionBody->tokens.push_back(
       Token{TokenType::ControlFlow, ControlFlowType::Else});
   // Else:
-  // n n 1 - factorial FunctionCall *
-  functionBody->tokens.push_back(Token{TokenType::Variable, std::string("n")});
-  functionBody->tokens.push_back(Token{TokenType::Variable, std::string("n")});
+  // n n 1 - factorial Call(1) *
+  functionBody->tokens.push_back(Token{TokenType::Variable, symbol("n")});
+  functionBody->tokens.push_back(Token{TokenType::Variable, symbol("n")});
   functionBody->tokens.push_back(
       Token{TokenType::Operand, ElgObject(std::make_shared<ElgPrimitive>(1))});
   functionBody->tokens.push_back(
       Token{TokenType::Operator, OperatorType::Subtract});
   functionBody->tokens.push_back(
-      Token{TokenType::Variable, std::string("factorial")});
+      Token{TokenType::Variable, symbol("factorial")});
   functionBody->tokens.push_back(
-      Token{TokenType::Operator, OperatorType::FunctionCall});
+      Token{TokenType::Call, Arity{1}});
   functionBody->tokens.push_back(
       Token{TokenType::Operator, OperatorType::Multiply});
   functionBody->tokens.push_back(
@@ -741,9 +1736,9 @@ void example() {
   funcCallExpr.tokens.push_back(
       Token{TokenType::Operand, ElgObject(std::make_shared<ElgPrimitive>(5))});
   funcCallExpr.tokens.push_back(
-      Token{TokenType::Variable, std::string("factorial")});
+      Token{TokenType::Variable, symbol("factorial")});
   funcCallExpr.tokens.push_back(
-      Token{TokenType::Operator, OperatorType::FunctionCall});
+      Token{TokenType::Call, Arity{1}});
 
   auto funcCallResult =
       interpreter.evaluateExpression(&funcCallExpr, &globalContext);
@@ -755,9 +1750,11 @@ void example() {
         Token{TokenType::Operand,
               ElgObject(std::make_shared<ElgPrimitive>("print"))});
     printExpr.tokens.push_back(
-        Token{TokenType::Operator, OperatorType::FunctionCall});
+        Token{TokenType::Call, Arity{1}});
 
     interpreter.evaluateExpression(&printExpr, &globalContext);
   }
 }
 }  // namespace elangRPN
+
+#endif  // ELANG_RPN_H
@@ -0,0 +1,97 @@
+// RpnGenerator.h
+#ifndef RPN_GENERATOR_H
+#define RPN_GENERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Lexer.h"
+#include "RPN.h"
+#include "Syntaxer.h"
+#include "TokenStream.h"
+
+// Генератор RPN: разбирает исходник и за тот же проход выдаёт программу для
+// elangRPN::Interpreter, без промежуточного дерева. Оператор выражения
+// выдаётся, как только готов его правый операнд (порядок сортировочной
+// станции), по той же таблице приоритетов, что у SyntaxAnalyzer. В памяти -
+// только окно токенов TokenStream и стек вызовов глубиной во вложенность.
+//
+// Операторы языка (Store - StoreLocal в функции, StoreGlobal вне функций):
+//   function f(a: T, ...): T { ... }  -> <функция> Store f
+//   let x = e  /  var x = e           -> e Store x
+//   x = e;                            -> e Store x
+//   e;                                -> e Pop
+//   if e { ... } elif e { ... } else { ... }
+//                                     -> e If ... Else e If ... Else ... EndIf EndIf
+//   while e { ... }                   -> e If While ... e EndWhile EndIf
+//   return e;                         -> e Return
+// Готовое тело функции и программа связываются (Expression::link): If, Else и
+// EndWhile заменяются переходами по смещениям.
+// Вызов f(a, b) выдаётся как a b f Call(2): вызываемое выражение переносится
+// за аргументы, потому что Call снимает его с вершины, а число аргументов
+// записывается в сам Call - вызов снимает их все, сколько бы параметров ни
+// было у функции.
+//
+// Переменные разрешаются в номера ячеек. Локальные переменные функции - её
+// параметры и все имена, которым в ней присваивается значение (присваивание
+// создаёт переменную в текущей функции); у каждой своя ячейка кадра. Чтение
+// имени сначала выдаётся как Variable, а когда функция дочитана и все её
+// локальные известны, такие токены в ней и во вложенных функциях заменяются
+// на LoadLocal с глубиной. Оставшиеся к концу программы - глобальные:
+// LoadGlobal по SymbolId.
+// Ячейка локальной переменной пуста до первого присваивания, и чтение пустой
+// ячейки берёт одноимённую переменную объемлющей функции или глобальную:
+// в function f() { x = x + 1; } правая часть читает внешнюю x, как при
+// поиске по вложенным контекстам.
+class RpnGenerator {
+ public:
+  // Разбор за один проход: токены вытягиваются из лексера по мере надобности
+  explicit RpnGenerator(Lexer& lexer);
+  // Разбор готового массива токенов; source - для позиций в ошибках
+  explicit RpnGenerator(const std::vector<Token>& tokens,
+                        std::shared_ptr<const SourceBuffer> source = nullptr);
+
+  // Программа целиком. Бросает SyntaxError на первой ошибке.
+  std::shared_ptr<elangRPN::Expression> generate();
+
+ private:
+  using Code = std::vector<elangRPN::Token>;
+
+  // Функция, которая сейчас разбирается
+  struct Scope {
+    elangRPN::Expression* body;
+    // Ячейки параметров (первые) и локальных переменных
+    std::unordered_map<SymbolId, uint32_t> slots;
+  };
+
+  TokenStream stream_;
+  std::shared_ptr<const SourceBuffer> source_;
+  // Разбираемые функции, внутренняя - последняя; пусто - верхний уровень
+  std::vector<Scope> scopes_;
+
+  const Token& current() { return stream_.peek(); }
+  void advance() { stream_.advance(); }
+  [[noreturn]] void fail(const std::string& message);
+  void expect(TokenType type, const char* spelling);
+  // Запись в переменную name текущей функции или в глобальную
+  void emitStore(Code& out, std::string_view name);
+
+  void parseStatements(Code& out);
+  void parseBlock(Code& out);
+  void parseStatement(Code& out);
+  void parseFunctionDeclaration(Code& out);
+  void parseVariableDeclaration(Code& out);
+  void parseIf(Code& out);
+  void parseWhile(Code& out);
+  void parseReturn(Code& out);
+  void parseExpression(Code& out, uint8_t minPrecedence = 0);
+  void parsePrefix(Code& out);
+  void parseCall(Code& out, size_t calleeStart);
+  void parsePrimary(Code& out);
+};
+
+#endif  // RPN_GENERATOR_H
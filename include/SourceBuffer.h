@@ -0,0 +1,62 @@
+// SourceBuffer.h
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Позиция в исходном тексте для сообщений об ошибках (строка и столбец с 1)
+struct SourcePosition {
+  int line;
+  int column;
+};
+
+// Неизменяемый буфер с исходным текстом программы.
+// Либо владеет копией строки, либо отображает файл в память только для чтения
+// (mmap), не копируя его содержимое. Токены лексера ссылаются на этот буфер
+// через std::string_view, поэтому буфер должен жить дольше токенов.
+class SourceBuffer {
+ public:
+  // Создаёт буфер, владеющий копией переданного текста
+  static std::shared_ptr<const SourceBuffer> fromString(std::string text);
+
+  // Отображает файл в память только для чтения.
+  // Бросает std::runtime_error, если файл не удаётся открыть или отобразить.
+  static std::shared_ptr<const SourceBuffer> mapFile(const std::string& path);
+
+  ~SourceBuffer();
+
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+  std::string_view view() const { return {data_, size_}; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool isMapped() const { return mapped_; }
+
+  // Строка и столбец символа по смещению (смещение за концом текста
+  // указывает на его конец). Столбец считается в кодовых точках UTF-8.
+  // Индекс переводов строк строится при первом вызове; вызов потокобезопасен.
+  SourcePosition position(size_t offset) const;
+
+ private:
+  SourceBuffer() = default;
+
+  const std::vector<uint32_t>& lineStarts() const;
+
+  std::string owned_;
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+
+  // Смещения начал строк, по возрастанию
+  mutable std::once_flag lineStartsOnce_;
+  mutable std::vector<uint32_t> lineStarts_;
+};
+
+#endif  // SOURCE_BUFFER_H
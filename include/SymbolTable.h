@@ -0,0 +1,53 @@
+// SymbolTable.h
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Плотный номер имени. Сравнение и хеширование имён во всём конвейере
+// (лексер, синтаксический анализатор, RPN) сводятся к операциям с числами.
+using SymbolId = uint32_t;
+inline constexpr SymbolId kNoSymbol = UINT32_MAX;
+
+// Таблица интернированных имён: каждое различное имя хранится один раз и
+// получает номер по порядку появления. Методы потокобезопасны.
+//
+// Имена из таблицы не удаляются по одному. global() живёт до конца процесса
+// и растёт на каждое новое имя, поэтому долгоживущие клиенты, которые лексят
+// всё новый текст (Document), держат свою таблицу и пересобирают её через
+// clear().
+class SymbolTable {
+ public:
+  SymbolTable() = default;
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  // Таблица процесса, которую заполняет лексер
+  static SymbolTable& global();
+
+  // Номер имени; новое имя добавляется в таблицу
+  SymbolId intern(std::string_view name);
+
+  // Имя по номеру; ссылка действительна, пока жива таблица
+  std::string_view name(SymbolId id) const;
+
+  size_t size() const;
+
+  // Удаляет все имена; выданные номера и ссылки name() становятся
+  // недействительными
+  void clear();
+
+ private:
+  mutable std::mutex mutex_;
+  // std::deque не перемещает элементы, ключи ids_ ссылаются на них
+  std::deque<std::string> names_;
+  std::unordered_map<std::string_view, SymbolId> ids_;
+};
+
+#endif  // SYMBOL_TABLE_H
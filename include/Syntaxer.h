@@ -1,47 +1,135 @@
 #ifndef ELANG_SYNTAXER_H
 #define ELANG_SYNTAXER_H
 
-#include "Token.h"
+#include "Ast.h"
+#include "token.h"
+#include "ThreadPool.h"
+#include "TokenStream.h"
 #include <vector>
 #include <stdexcept>
 #include <iostream>
 
+// Синтаксическая ошибка, записанная при разборе
+struct Diagnostic {
+    uint32_t offset;
+    int line;    // 0, если исходный текст неизвестен
+    int column;
+    std::string message;
+};
+
 class SyntaxError : public std::runtime_error {
 public:
     SyntaxError(const std::string& message, int line, int column)
             : std::runtime_error("Syntax error at line " + std::to_string(line) + ", column " + std::to_string(column) + ": " + message) {}
+    // Исходный текст неизвестен: позиция задаётся смещением
+    SyntaxError(const std::string& message, uint32_t offset)
+            : std::runtime_error("Syntax error at offset " + std::to_string(offset) + ": " + message) {}
+    explicit SyntaxError(const Diagnostic& d)
+            : SyntaxError(d.line > 0 ? SyntaxError(d.message, d.line, d.column) : SyntaxError(d.message, d.offset)) {}
 };
 
 class SyntaxAnalyzer {
+public:
+    // Как инфиксный оператор присоединяет левую часть
+    enum class InfixForm : uint8_t {
+        Binary,  // a op b
+        Call,    // a(аргументы)
+        Member,  // a.имя
+    };
+
+    // Строка таблицы операторов выражений, индекс - TokenType
+    struct OperatorRule {
+        uint8_t prefix = 0;  // уровень как префиксного оператора, 0 - не префиксный
+        uint8_t infix = 0;   // уровень как инфиксного оператора, 0 - не инфиксный
+        bool rightAssoc = false;
+        InfixForm form = InfixForm::Binary;
+    };
+
+    static const OperatorRule& operatorRule(TokenType type);
+    // Токен, с которого вне фигурных скобок начинается объявление верхнего
+    // уровня (граница для параллельного и инкрементального разбора)
+    static bool startsDeclaration(TokenType type);
+
 private:
-    std::vector<Token> tokens_;
-    size_t currentIndex_ = 0;
+    TokenStream stream_;
+    // Текст, по которому вычисляются строка и столбец в сообщениях об ошибках
+    std::shared_ptr<const SourceBuffer> source_;
+    // Дерево разбора; узлы в арене, ссылки - номера узлов
+    Ast ast_;
+    // Найденные ошибки; без восстановления - не больше одной
+    std::vector<Diagnostic> diagnostics_;
+    // Продолжать разбор после ошибки
+    bool recover_ = false;
+    // Номер токена, на котором кончается разбираемый участок (параллельный
+    // разбор); операторы верхнего уровня начинаются только до него
+    size_t limit_ = SIZE_MAX;
 
-    Token& current();
+    // Участок параллельного разбора: тот же поток токенов
+    SyntaxAnalyzer(const TokenStream& stream, std::shared_ptr<const SourceBuffer> source);
+
+    const Token& current();
+    // Ошибки не бросаются: функции разбора возвращают kNoNode (false),
+    // и вызывающие сразу передают неудачу выше до списка операторов
+    NodeId fail(const std::string& message);
     void advance();
-    void expect(TokenType type);
+    bool expect(TokenType type);
+    void synchronize(uint32_t start);
     std::string tokenTypeToString(TokenType type);
 
-    void parseProgram();
-    void parseStatement();
-    void parseFunctionDeclaration();
-    void parseParameters();
-    void parseVariableDeclaration();
-    void parseType();
-    void parseExpressionStatement();
-    void parseExpression();
-    void parseLogicalOr();
-    void parseLogicalAnd();
-    void parseEquality();
-    void parseRelational();
-    void parseAdditive();
-    void parseMultiplicative();
-    void parseUnary();
-    void parsePrimary();
+    NodeId leaf(NodeKind kind, const Token& tok);
+    NodeId binary(const Token& op, NodeId left, NodeId right);
+
+    void run(bool recover);
+    void runParallel(bool recover, ThreadPool& pool);
+    bool atLimit() const { return limit_ != SIZE_MAX && stream_.position() >= limit_; }
+    NodeId parseProgram();
+    bool parseStatements(ChildList& statements);
+    NodeId parseStatement();
+    NodeId parseFunctionDeclaration();
+    bool parseParameters(ChildList& parameters);
+    NodeId parseVariableDeclaration();
+    NodeId parseType();
+    NodeId parseExpressionStatement();
+    NodeId parseExpression(uint8_t minPrecedence = 0);
+    NodeId parsePrefix();
+    NodeId parseCall(const Token& paren, NodeId callee);
+    NodeId parsePrimary();
 
 public:
-    SyntaxAnalyzer(const std::vector<Token>& tokens);
+    // Разбор готового массива токенов (массив не копируется и должен жить до конца разбора).
+    // source - текст, из которого получены токены, для позиций в ошибках
+    SyntaxAnalyzer(const std::vector<Token>& tokens, std::shared_ptr<const SourceBuffer> source = nullptr);
+    // Разбор за один проход: токены вытягиваются из лексера по мере надобности
+    explicit SyntaxAnalyzer(Lexer& lexer);
+    // Разбор компактного буфера токенов
+    explicit SyntaxAnalyzer(const TokenBuffer& buffer);
+    // Строит дерево разбора (ast().root() - узел Program).
+    // Текст узлов ссылается на исходник и строки лексера.
+    // Бросает SyntaxError на первой ошибке.
     void analyze();
+    // Разбор со сбором всех ошибок за один проход, без исключений: после
+    // ошибки оператор пропускается до ";", "}" или начала следующего
+    // объявления (function, let, var, GET/POST/PUT/DELETE), и разбор
+    // продолжается. Дерево содержит только операторы без ошибок.
+    // Возвращает true, если ошибок нет.
+    bool analyzeAll();
+    // То же, но объявления верхнего уровня (function, let, var и блоки
+    // GET/POST/PUT/DELETE) разбираются параллельно, а результаты сливаются
+    // в одно дерево в порядке исходника. Дерево и ошибки те же, что у
+    // последовательного разбора. Для потока из лексера разбор
+    // последовательный: границы объявлений ищутся по готовым токенам.
+    void analyzeParallel(ThreadPool& pool = ThreadPool::shared());
+    bool analyzeAllParallel(ThreadPool& pool = ThreadPool::shared());
+    // analyzeAll() для операторов верхнего уровня, начинающихся до токена с
+    // номером end. Следующие токены видны только как просмотр вперёд, чтобы
+    // ошибка на границе называла тот же токен, что и при разборе целиком.
+    bool analyzeAllUntil(size_t end);
+    const std::vector<Diagnostic>& diagnostics() const { return diagnostics_; }
+    // Номер токена, на котором остановился разбор; после ошибки analyze() и
+    // analyzeParallel() - ошибочный токен
+    size_t position() const { return stream_.position(); }
+    const Ast& ast() const { return ast_; }
+    Ast& ast() { return ast_; }
 };
 
 #endif //ELANG_SYNTAXER_H
@@ -0,0 +1,58 @@
+// ThreadPool.h
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков для параллельных проходов транслятора (fork-join).
+// parallelFor раздаёт индексы 0..count-1 рабочим потокам и вызывающему
+// потоку и возвращается, когда все они обработаны. Вложенный parallelFor
+// (из тела задания) выполняется целиком на вызвавшем его потоке.
+// Если fn бросает исключение, оставшиеся индексы не раздаются, parallelFor
+// дожидается потоков, уже занятых заданием, и бросает первое исключение.
+class ThreadPool {
+ public:
+  // threads == 0 - по числу аппаратных потоков
+  explicit ThreadPool(size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Общий пул процесса
+  static ThreadPool& shared();
+
+  // Число потоков, включая вызывающий
+  size_t size() const { return workers_.size() + 1; }
+
+  void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+ private:
+  void workerLoop();
+  void runIndices();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  bool stopping_ = false;
+
+  // Текущее задание
+  uint64_t generation_ = 0;
+  const std::function<void(size_t)>* job_ = nullptr;
+  size_t count_ = 0;
+  std::atomic<size_t> nextIndex_{0};
+  size_t activeWorkers_ = 0;
+  // Первое исключение из задания
+  std::exception_ptr error_;
+};
+
+#endif  // THREAD_POOL_H
@@ -0,0 +1,86 @@
+// TokenBuffer.h
+#ifndef TOKEN_BUFFER_H
+#define TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SourceBuffer.h"
+#include "token.h"
+
+class Lexer;
+
+// Компактное хранилище токенов в виде параллельных массивов
+// (structure of arrays): вид токена, смещение и длина значения в исходном
+// тексте, номер символа, номер значения литерала. Около 17 байт на токен
+// вместо ~56 у Token, без выделения памяти на каждый токен. Строку и столбец по смещению вычисляет
+// source()->position().
+//
+// Token остаётся материализованным представлением одного токена (at()),
+// например для диагностики.
+class TokenBuffer {
+ public:
+  explicit TokenBuffer(std::shared_ptr<const SourceBuffer> source)
+      : source_(std::move(source)) {}
+
+  // Лексит весь оставшийся ввод лексера в буфер
+  static TokenBuffer fromLexer(Lexer& lexer);
+
+  void push(const Token& tok);
+  void reserve(size_t count);
+
+  size_t size() const { return kinds_.size(); }
+  bool empty() const { return kinds_.empty(); }
+
+  TokenType type(size_t i) const { return static_cast<TokenType>(kinds_[i] & kKindMask); }
+  uint32_t offset(size_t i) const { return offsets_[i]; }
+  uint32_t length(size_t i) const { return lengths_[i]; }
+  SymbolId symbol(size_t i) const { return symbols_[i]; }
+
+  // Раскодированное лексером значение литерала (по виду токена)
+  int64_t intValue(size_t i) const;
+  double floatValue(size_t i) const;
+  bool boolValue(size_t i) const;
+
+  // Значение токена: срез исходного текста либо раскодированная строка
+  std::string_view text(size_t i) const;
+
+  // Материализованный токен
+  Token at(size_t i) const;
+
+  const std::shared_ptr<const SourceBuffer>& source() const { return source_; }
+
+ private:
+  // Старший бит вида: значение токена лежит не в исходном тексте
+  static constexpr uint8_t kDecodedFlag = 0x80;
+  static constexpr uint8_t kKindMask = 0x7F;
+
+  std::shared_ptr<const SourceBuffer> source_;
+
+  std::vector<uint8_t> kinds_;
+  // Смещение начала токена в исходном тексте и длина его значения
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> lengths_;
+  std::vector<SymbolId> symbols_;
+  // Номер значения токена в literals_ (числовые и булевы литералы) или в
+  // decoded_ (kDecodedFlag), иначе kNoPayload. Отдельный столбец, а не поиск
+  // по номеру токена: проход по буферу обращается к значениям за O(1).
+  std::vector<uint32_t> payloads_;
+
+  // Раскодированные значения (строки с escape-последовательностями)
+  std::deque<std::string> decoded_;
+  // Значения числовых и булевых литералов (биты Token::intValue)
+  std::vector<int64_t> literals_;
+
+  static constexpr uint32_t kNoPayload = UINT32_MAX;
+
+  static bool hasLiteral(TokenType type);
+  int64_t literalBits(size_t i) const;
+};
+
+#endif  // TOKEN_BUFFER_H
@@ -0,0 +1,58 @@
+// TokenStream.h
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "Lexer.h"
+#include "TokenBuffer.h"
+#include "token.h"
+
+// Поток токенов с ограниченным просмотром вперёд.
+// Либо вытягивает токены из лексера по одному (лексический и синтаксический
+// анализ идут за один проход, в памяти не больше kLookahead токенов), либо
+// читает уже готовый массив без его копирования, либо последовательно
+// материализует токены из компактного TokenBuffer.
+class TokenStream {
+ public:
+  static constexpr size_t kLookahead = 8;  // степень двойки
+
+  explicit TokenStream(Lexer& lexer) : lexer_(&lexer) {}
+  explicit TokenStream(std::span<const Token> tokens) : tokens_(tokens) {}
+  explicit TokenStream(const TokenBuffer& buffer) : buffer_(&buffer) {}
+
+  // Токен на k позиций впереди текущего (k < kLookahead).
+  // За концом ввода всегда возвращается EndOfFile.
+  const Token& peek(size_t k = 0);
+
+  // Возвращает текущий токен и переходит к следующему
+  Token next();
+  void advance();
+
+  // Произвольный доступ - для готового массива и TokenBuffer, но не для
+  // лексера: число токенов, вид i-го, номер текущего и переход к i-му
+  bool randomAccess() const { return lexer_ == nullptr; }
+  size_t size() const { return buffer_ ? buffer_->size() : tokens_.size(); }
+  TokenType type(size_t i) const { return buffer_ ? buffer_->type(i) : tokens_[i].type; }
+  size_t position() const { return buffer_ ? index_ - count_ : index_; }
+  void seek(size_t i);
+
+ private:
+  Lexer* lexer_ = nullptr;
+  const TokenBuffer* buffer_ = nullptr;
+  std::span<const Token> tokens_;
+  size_t index_ = 0;
+
+  // Кольцевой буфер для режимов с лексером и с TokenBuffer
+  std::array<Token, kLookahead> ring_;
+  size_t head_ = 0;
+  size_t count_ = 0;
+
+  Token pull();
+  bool usesRing() const { return lexer_ != nullptr || buffer_ != nullptr; }
+  static const Token& endOfFile();
+};
+
+#endif  // TOKEN_STREAM_H
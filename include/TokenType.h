@@ -2,8 +2,11 @@
 #ifndef TOKENTYPE_H
 #define TOKENTYPE_H
 
-#include <string>
-#include <unordered_set>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
 
 enum class TokenType {
   // Специальные токены
@@ -13,6 +16,7 @@ enum class TokenType {
   // Идентификаторы и литералы
   Identifier,
   IntegerLiteral,
+  FloatLiteral,
   StringLiteral,
   BooleanLiteral,
   ListLiteral,
@@ -41,6 +45,14 @@ enum class TokenType {
   KW_FALSE,
   KW_UNDEFINED,
   KW_NULL,
+  KW_ELIF,
+  KW_SWITCH,
+  KW_BREAK,
+  KW_CONTINUE,
+  KW_GET,
+  KW_POST,
+  KW_PUT,
+  KW_DELETE,
 
   // Операторы
   OP_ASSIGN,         // =
@@ -58,7 +70,7 @@ enum class TokenType {
   OP_AND,            // &&
   OP_OR,             // ||
   OP_NOT,            // !
-  OP_ARROW,          // =>
+  OP_ARROW,          // ->
   OP_DOUBLE_ARROW,  // => (для сопоставления с образцом)
 
   // Разделители
@@ -77,39 +89,156 @@ enum class TokenType {
   // Добавьте другие токены по необходимости
 };
 
+struct KeywordSpelling {
+  std::string_view text;
+  TokenType type;
+};
+
+// Все ключевые слова языка (включая HTTP-методы из config/keywords.txt)
+inline constexpr KeywordSpelling kKeywords[] = {
+    {"function", TokenType::KW_FUNCTION},
+    {"var", TokenType::KW_VAR},
+    {"let", TokenType::KW_LET},
+    {"struct", TokenType::KW_STRUCT},
+    {"exception", TokenType::KW_EXCEPTION},
+    {"middleware", TokenType::KW_MIDDLEWARE},
+    {"endpoint", TokenType::KW_ENDPOINT},
+    {"apply", TokenType::KW_APPLY},
+    {"if", TokenType::KW_IF},
+    {"elif", TokenType::KW_ELIF},
+    {"else", TokenType::KW_ELSE},
+    {"return", TokenType::KW_RETURN},
+    {"match", TokenType::KW_MATCH},
+    {"switch", TokenType::KW_SWITCH},
+    {"throw", TokenType::KW_THROW},
+    {"for", TokenType::KW_FOR},
+    {"in", TokenType::KW_IN},
+    {"while", TokenType::KW_WHILE},
+    {"break", TokenType::KW_BREAK},
+    {"continue", TokenType::KW_CONTINUE},
+    {"async", TokenType::KW_ASYNC},
+    {"await", TokenType::KW_AWAIT},
+    {"true", TokenType::KW_TRUE},
+    {"false", TokenType::KW_FALSE},
+    {"undefined", TokenType::KW_UNDEFINED},
+    {"null", TokenType::KW_NULL},
+    {"GET", TokenType::KW_GET},
+    {"POST", TokenType::KW_POST},
+    {"PUT", TokenType::KW_PUT},
+    {"DELETE", TokenType::KW_DELETE},
+};
+
+struct OperatorSpelling {
+  std::string_view text;
+  TokenType type;
+};
+
+// Операторы и разделители. Табличный лексер строит по этому списку свой
+// автомат, поэтому новый оператор достаточно добавить сюда.
+inline constexpr OperatorSpelling kOperators[] = {
+    {"=", TokenType::OP_ASSIGN},
+    {"+", TokenType::OP_PLUS},
+    {"-", TokenType::OP_MINUS},
+    {"*", TokenType::OP_MULTIPLY},
+    {"/", TokenType::OP_DIVIDE},
+    {"%", TokenType::OP_MODULO},
+    {"==", TokenType::OP_EQUAL},
+    {"!=", TokenType::OP_NOT_EQUAL},
+    {"<", TokenType::OP_LESS},
+    {">", TokenType::OP_GREATER},
+    {"<=", TokenType::OP_LESS_EQUAL},
+    {">=", TokenType::OP_GREATER_EQUAL},
+    {"&&", TokenType::OP_AND},
+    {"||", TokenType::OP_OR},
+    {"!", TokenType::OP_NOT},
+    {"->", TokenType::OP_ARROW},
+    {"=>", TokenType::OP_DOUBLE_ARROW},
+    {"(", TokenType::LPAREN},
+    {")", TokenType::RPAREN},
+    {"{", TokenType::LBRACE},
+    {"}", TokenType::RBRACE},
+    {"[", TokenType::LBRACKET},
+    {"]", TokenType::RBRACKET},
+    {",", TokenType::COMMA},
+    {":", TokenType::COLON},
+    {";", TokenType::SEMICOLON},
+    {".", TokenType::DOT},
+};
+
+// Совершенный хеш ключевых слов, построенный во время компиляции.
+// Ключ - длина, первый и последний символы; множитель подбирается так, чтобы
+// все ключевые слова попали в разные ячейки. Проверка идентификатора -
+// одно обращение к таблице и одно сравнение memcmp.
+namespace keyword_hash {
+
+inline constexpr uint32_t kBits = 6;
+inline constexpr size_t kTableSize = size_t{1} << kBits;
+
+constexpr size_t minLength() {
+  size_t result = SIZE_MAX;
+  for (const auto& kw : kKeywords) result = kw.text.size() < result ? kw.text.size() : result;
+  return result;
+}
+
+constexpr size_t maxLength() {
+  size_t result = 0;
+  for (const auto& kw : kKeywords) result = kw.text.size() > result ? kw.text.size() : result;
+  return result;
+}
+
+inline constexpr size_t kMinLength = minLength();
+inline constexpr size_t kMaxLength = maxLength();
+
+// str.size() >= 1
+constexpr uint32_t slot(std::string_view str, uint32_t multiplier) {
+  uint32_t key = static_cast<uint32_t>(str.size()) |
+                 static_cast<uint32_t>(static_cast<unsigned char>(str.front())) << 8 |
+                 static_cast<uint32_t>(static_cast<unsigned char>(str.back())) << 16;
+  return (key * multiplier) >> (32 - kBits);
+}
+
+constexpr bool isPerfect(uint32_t multiplier) {
+  bool used[kTableSize] = {};
+  for (const auto& kw : kKeywords) {
+    uint32_t s = slot(kw.text, multiplier);
+    if (used[s]) return false;
+    used[s] = true;
+  }
+  return true;
+}
+
+constexpr uint32_t findMultiplier() {
+  // Перебор нечётных множителей от константы Кнута
+  for (uint32_t m = 2654435761u; m != 2654435761u + 2u * 1000000u; m += 2) {
+    if (isPerfect(m)) return m;
+  }
+  return 0;
+}
+
+inline constexpr uint32_t kMultiplier = findMultiplier();
+static_assert(kMultiplier != 0, "no perfect hash multiplier for the keyword set");
+
+constexpr std::array<KeywordSpelling, kTableSize> buildTable() {
+  std::array<KeywordSpelling, kTableSize> table{};
+  for (auto& entry : table) entry = {std::string_view(), TokenType::Identifier};
+  for (const auto& kw : kKeywords) table[slot(kw.text, kMultiplier)] = kw;
+  return table;
+}
+
+inline constexpr std::array<KeywordSpelling, kTableSize> kTable = buildTable();
+
+}  // namespace keyword_hash
+
 // Функция для проверки, является ли строка ключевым словом
-inline TokenType checkKeyword(const std::string& str) {
-  static const std::unordered_set<std::string> keywords = {
-      "function",   "var",      "let",   "struct", "exception",
-      "middleware", "endpoint", "apply", "if",     "else",
-      "return",     "match",    "throw", "for",    "in",
-      "while",      "async",    "await", "true",   "false",
-      "undefined", "null",
-    };
-
-  if (keywords.find(str) != keywords.end()) {
-    if (str == "function") return TokenType::KW_FUNCTION;
-    if (str == "var") return TokenType::KW_VAR;
-    if (str == "let") return TokenType::KW_LET;
-    if (str == "struct") return TokenType::KW_STRUCT;
-    if (str == "exception") return TokenType::KW_EXCEPTION;
-    if (str == "middleware") return TokenType::KW_MIDDLEWARE;
-    if (str == "endpoint") return TokenType::KW_ENDPOINT;
-    if (str == "apply") return TokenType::KW_APPLY;
-    if (str == "if") return TokenType::KW_IF;
-    if (str == "else") return TokenType::KW_ELSE;
-    if (str == "return") return TokenType::KW_RETURN;
-    if (str == "match") return TokenType::KW_MATCH;
-    if (str == "throw") return TokenType::KW_THROW;
-    if (str == "for") return TokenType::KW_FOR;
-    if (str == "in") return TokenType::KW_IN;
-    if (str == "while") return TokenType::KW_WHILE;
-    if (str == "async") return TokenType::KW_ASYNC;
-    if (str == "await") return TokenType::KW_AWAIT;
-    if (str == "true") return TokenType::KW_TRUE;
-    if (str == "false") return TokenType::KW_FALSE;
-    if (str == "undefined") return TokenType::KW_UNDEFINED;
-    if (str == "null") return TokenType::KW_NULL;
+inline TokenType checkKeyword(std::string_view str) {
+  if (str.size() < keyword_hash::kMinLength || str.size() > keyword_hash::kMaxLength) {
+    return TokenType::Identifier;
+  }
+  const KeywordSpelling& entry =
+      keyword_hash::kTable[keyword_hash::slot(str, keyword_hash::kMultiplier)];
+  if (entry.text.size() == str.size() &&
+      std::memcmp(entry.text.data(), str.data(), str.size()) == 0) {
+    return entry.type;
   }
   return TokenType::Identifier;
 }
@@ -2,17 +2,33 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <cstdint>
+#include <string_view>
+
+#include "SymbolTable.h"
 #include "TokenType.h"
 
+// Значение токена не владеет памятью: это срез исходного текста (SourceBuffer)
+// либо строки, раскодированной лексером (строковые литералы с escape-
+// последовательностями). Токены действительны, пока живы лексер и его буфер.
+// Строка и столбец не хранятся: их по offset вычисляет SourceBuffer::position.
 struct Token {
   TokenType type;
-  std::string value;
-  int line;
-  int column;
+  std::string_view value;
+  // Смещение первого символа токена в исходном тексте
+  uint32_t offset;
+  // Номер имени в таблице символов лексера (только у Identifier)
+  SymbolId symbol = kNoSymbol;
+  // Значение литерала, раскодированное лексером; поле выбирается по type
+  union {
+    int64_t intValue = 0;  // IntegerLiteral
+    double floatValue;     // FloatLiteral
+    bool boolValue;        // BooleanLiteral
+  };
 
-  Token(TokenType type = TokenType::Unknown, const std::string& value = "",
-        int line = 0, int column = 0)
-      : type(type), value(value), line(line), column(column) {}
+  Token(TokenType type = TokenType::Unknown, std::string_view value = {},
+        uint32_t offset = 0)
+      : type(type), value(value), offset(offset) {}
 };
 
 #endif  // TOKEN_H
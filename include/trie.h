@@ -1,23 +1,124 @@
 #ifndef TRANSLATOR_TRIE_H
 #define TRANSLATOR_TRIE_H
 
-#include <fstream>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
-#include <set>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
+#include "SourceBuffer.h"
+
+// Префиксное дерево в виде двойного массива (double-array trie).
+// Всё дерево - два непрерывных массива base/check без выделения памяти на
+// узел: переход из состояния s по байту c ведёт в t = base[s] + code(c) и
+// существует, только если check[t] == s. Конец слова - переход по коду 0,
+// base листа хранит значение, связанное со словом.
+//
+// Массивы перестраиваются из отсортированного набора слов при первом запросе
+// после AddString, поэтому сначала добавляются все слова, затем идут запросы.
+// Перестройка не потокобезопасна; построенное дерево (например, из FromFile)
+// можно опрашивать из нескольких потоков.
+//
+// Построенное дерево сохраняется в плоский образ (Save) - заголовок и оба
+// массива как есть. Массивы хранят только индексы, поэтому образ не зависит
+// от адреса: Load отображает файл в память и опрашивает его на месте, без
+// разбора и выделения памяти.
 class Trie {
  public:
+    struct Match {
+        size_t length = 0;   // 0 - ни одно слово не является префиксом
+        uint32_t value = 0;  // значение найденного слова
+    };
+
+    // Версия формата образа; меняется при любом изменении раскладки
+    static constexpr uint32_t kImageVersion = 1;
+
     Trie();
-    void AddString(std::string& str);
-    bool Contains(std::string& str);
+
+    // Слова из файла, по одному в строке; пустые строки пропускаются.
+    // Бросает std::runtime_error, если файл не удаётся открыть.
+    static Trie FromFile(const std::string& path);
+
+    // Отображает образ, записанный Save с тем же sourceHash. Пустой результат,
+    // если файла нет или он устарел: другая версия формата, другой
+    // sourceHash, не сходится размер или контрольная сумма.
+    static std::optional<Trie> Load(const std::string& path, uint64_t sourceHash);
+
+    // Записывает образ дерева. sourceHash - отпечаток данных, из которых
+    // построено дерево (см. Hash); по нему Load отличает устаревший образ.
+    // Файл заменяется атомарно. Бросает std::runtime_error при ошибке записи.
+    void Save(const std::string& path, uint64_t sourceHash) const;
+
+    // FNV-1a; hash - результат предыдущего вызова, чтобы хешировать по частям
+    static uint64_t Hash(std::string_view bytes, uint64_t hash = kHashSeed);
+
+    // Для дерева из образа сначала восстанавливает набор слов
+    void AddString(std::string_view str, uint32_t value = 0);
+    bool Contains(std::string_view str) const;
+
+    // Самое длинное слово, являющееся префиксом [p, end) (максимальное
+    // совпадение): за один проход по вводу, без повторного сравнения строк
+    Match LongestMatch(const char* p, const char* end) const;
+
+    // Строит массивы сразу, не дожидаясь первого запроса
+    void Build() const;
+
+    size_t Size() const { return image_ ? imageWords_ : words_.size(); }
+    // Число ячеек двойного массива
+    size_t Capacity() const { return View().size; }
+    // Дерево опрашивается прямо в отображённом образе
+    bool IsMapped() const { return image_ != nullptr; }
 
  private:
-    struct Node {
-        std::unordered_map<char, Node*> to;
-        bool is_terminal = false;
+    static constexpr uint64_t kHashSeed = 14695981039346656037ull;
+    // Код 0 зарезервирован за концом слова
+    static constexpr int32_t kFree = -1;
+    // check корня: ячейка занята, но не является переходом ни из какого состояния
+    static constexpr int32_t kRootCheck = -2;
+
+    static int32_t Code(char c) { return static_cast<unsigned char>(c) + 1; }
+
+    // Массивы, по которым идут запросы: собственные или из образа
+    struct Cells {
+        const int32_t* base;
+        const int32_t* check;
+        size_t size;
     };
-    Node* root_;
+
+    // Переход из state по коду; -1, если его нет
+    static int32_t Next(const Cells& cells, int32_t state, int32_t code) {
+        int32_t t = cells.base[state] + code;
+        return static_cast<size_t>(t) < cells.size && cells.check[t] == state ? t : -1;
+    }
+
+    Cells View() const;
+
+    using WordIt = std::map<std::string, uint32_t>::const_iterator;
+
+    // Строит поддерево state из слов [first, last) с общим префиксом длины depth
+    void BuildNode(int32_t state, size_t depth, WordIt first, WordIt last) const;
+    // Наименьшая база, при которой свободны ячейки всех кодов codes
+    int32_t FindBase(const std::vector<int32_t>& codes) const;
+    void Reserve(size_t size) const;
+
+    // Переносит слова из образа в words_, после чего образ больше не нужен
+    void Unmap();
+    void CollectWords(const Cells& cells, int32_t state, std::string& prefix);
+
+    std::map<std::string, uint32_t> words_;
+
+    mutable bool dirty_ = false;
+    mutable std::vector<int32_t> base_;
+    mutable std::vector<int32_t> check_;
+    // Подсказка для поиска свободных ячеек при построении
+    mutable int32_t firstFree_ = 1;
+
+    // Отображённый образ (Load) и число слов в нём
+    std::shared_ptr<const SourceBuffer> image_;
+    size_t imageWords_ = 0;
 };
 
 #endif //TRANSLATOR_TRIE_H
@@ -0,0 +1,91 @@
+// Ast.cpp
+#include "../include/Ast.h"
+
+namespace {
+
+const char* kindName(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::Program: return "Program";
+        case NodeKind::FunctionDecl: return "FunctionDecl";
+        case NodeKind::Parameter: return "Parameter";
+        case NodeKind::Type: return "Type";
+        case NodeKind::Block: return "Block";
+        case NodeKind::VariableDecl: return "VariableDecl";
+        case NodeKind::ExpressionStatement: return "ExpressionStatement";
+        case NodeKind::Binary: return "Binary";
+        case NodeKind::Unary: return "Unary";
+        case NodeKind::Call: return "Call";
+        case NodeKind::Literal: return "Literal";
+        case NodeKind::Identifier: return "Identifier";
+    }
+    return "?";
+}
+
+}  // namespace
+
+NodeId Ast::add(NodeKind kind, uint32_t offset, TokenType op) {
+    if (size_ == chunks_.size() * kChunkSize) {
+        chunks_.push_back(std::make_unique_for_overwrite<AstNode[]>(kChunkSize));
+    }
+    NodeId id = static_cast<NodeId>(size_++);
+    AstNode& node = (*this)[id];
+    node.kind = kind;
+    node.op = op;
+    node.offset = offset;
+    node.symbol = kNoSymbol;
+    node.firstChild = kNoNode;
+    node.nextSibling = kNoNode;
+    node.text = {};
+    node.intValue = 0;
+    return id;
+}
+
+NodeId Ast::append(const Ast& other, NodeId begin, NodeId end) {
+    NodeId base = static_cast<NodeId>(size_);
+    for (NodeId id = begin; id < end; ++id) {
+        AstNode& node = (*this)[add(NodeKind::Program, 0)];
+        node = other[id];
+        if (node.firstChild != kNoNode) {
+            node.firstChild = node.firstChild - begin + base;
+        }
+        if (node.nextSibling != kNoNode) {
+            node.nextSibling = node.nextSibling - begin + base;
+        }
+    }
+    return base;
+}
+
+size_t Ast::childCount(NodeId id) const {
+    size_t count = 0;
+    for (NodeId child = (*this)[id].firstChild; child != kNoNode; child = (*this)[child].nextSibling) {
+        ++count;
+    }
+    return count;
+}
+
+std::string Ast::dump(NodeId id) const {
+    std::string out;
+    dump(id, out);
+    return out;
+}
+
+void Ast::dump(NodeId id, std::string& out) const {
+    const AstNode& node = (*this)[id];
+    out += '(';
+    out += kindName(node.kind);
+    if (!node.text.empty()) {
+        out += ' ';
+        if (node.kind == NodeKind::Literal && node.op == TokenType::StringLiteral) {
+            out += '"';
+            out += node.text;
+            out += '"';
+        } else {
+            out += node.text;
+        }
+    }
+    for (NodeId child = node.firstChild; child != kNoNode; child = (*this)[child].nextSibling) {
+        out += ' ';
+        dump(child, out);
+    }
+    out += ')';
+}
@@ -0,0 +1,358 @@
+// CharScan.cpp
+#include "../include/CharScan.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define CHARSCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace charscan {
+namespace {
+
+// ---------------------------------------------------------------------------
+// Скалярная реализация (эталон для векторных)
+// ---------------------------------------------------------------------------
+
+inline bool isSpace(unsigned char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+inline bool isDigit(unsigned char c) { return static_cast<unsigned>(c - '0') < 10u; }
+inline bool isIdent(unsigned char c) {
+    return static_cast<unsigned>((c | 0x20) - 'a') < 26u || isDigit(c) || c == '_';
+}
+
+const char* scalarSkipWhitespace(const char* p, const char* end) {
+    while (p < end && isSpace(static_cast<unsigned char>(*p))) ++p;
+    return p;
+}
+
+const char* scalarFindLineEnd(const char* p, const char* end) {
+    while (p < end && *p != '\n' && *p != '\0') ++p;
+    return p;
+}
+
+const char* scalarFindStarOrNul(const char* p, const char* end) {
+    while (p < end && *p != '*' && *p != '\0') ++p;
+    return p;
+}
+
+const char* scalarIdentifierEnd(const char* p, const char* end) {
+    while (p < end && isIdent(static_cast<unsigned char>(*p))) ++p;
+    return p;
+}
+
+const char* scalarDigitsEnd(const char* p, const char* end) {
+    while (p < end && isDigit(static_cast<unsigned char>(*p))) ++p;
+    return p;
+}
+
+size_t scalarCountNewlines(const char* p, const char* end) {
+    size_t count = 0;
+    for (; p < end; ++p) count += (*p == '\n');
+    return count;
+}
+
+size_t scalarFindNewlines(const char* p, const char* end, uint32_t* out) {
+    size_t count = 0;
+    for (const char* q = p; q < end; ++q) {
+        if (*q == '\n') out[count++] = static_cast<uint32_t>(q - p);
+    }
+    return count;
+}
+
+// Выписывает номера установленных битов маски (позиции найденных байтов)
+inline size_t emitBits(unsigned mask, uint32_t base, uint32_t* out) {
+    size_t count = 0;
+    while (mask) {
+        out[count++] = base + static_cast<uint32_t>(__builtin_ctz(mask));
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+constexpr Kernels kScalar = {
+    scalarSkipWhitespace, scalarFindLineEnd,   scalarFindStarOrNul,
+    scalarIdentifierEnd,  scalarDigitsEnd,     scalarCountNewlines,
+    scalarFindNewlines,
+};
+
+#ifdef CHARSCAN_X86
+
+// ---------------------------------------------------------------------------
+// SSE2: 16 байт за шаг
+// ---------------------------------------------------------------------------
+
+// Байты из диапазона [lo, lo + span] (беззнаковое сравнение через min)
+inline __m128i sseInRange(__m128i v, char lo, char span) {
+    __m128i t = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(span)), t);
+}
+
+inline __m128i sseSpace(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), sseInRange(v, '\t', '\r' - '\t'));
+}
+
+inline __m128i sseDigit(__m128i v) { return sseInRange(v, '0', 9); }
+
+inline __m128i sseIdent(__m128i v) {
+    __m128i alpha = sseInRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 25);
+    __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(alpha, sseDigit(v)), under);
+}
+
+inline unsigned sseMask(__m128i m) { return static_cast<unsigned>(_mm_movemask_epi8(m)); }
+
+inline __m128i sseLoad(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+
+const char* sse2SkipWhitespace(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned miss = ~sseMask(sseSpace(sseLoad(p))) & 0xFFFFu;
+        if (miss) return p + __builtin_ctz(miss);
+    }
+    return scalarSkipWhitespace(p, end);
+}
+
+const char* sse2FindLineEnd(const char* p, const char* end) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i nul = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16) {
+        __m128i v = sseLoad(p);
+        unsigned hit = sseMask(_mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, nul)));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return scalarFindLineEnd(p, end);
+}
+
+const char* sse2FindStarOrNul(const char* p, const char* end) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i nul = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16) {
+        __m128i v = sseLoad(p);
+        unsigned hit = sseMask(_mm_or_si128(_mm_cmpeq_epi8(v, star), _mm_cmpeq_epi8(v, nul)));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return scalarFindStarOrNul(p, end);
+}
+
+const char* sse2IdentifierEnd(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned miss = ~sseMask(sseIdent(sseLoad(p))) & 0xFFFFu;
+        if (miss) return p + __builtin_ctz(miss);
+    }
+    return scalarIdentifierEnd(p, end);
+}
+
+const char* sse2DigitsEnd(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned miss = ~sseMask(sseDigit(sseLoad(p))) & 0xFFFFu;
+        if (miss) return p + __builtin_ctz(miss);
+    }
+    return scalarDigitsEnd(p, end);
+}
+
+size_t sse2CountNewlines(const char* p, const char* end) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    size_t count = 0;
+    for (; end - p >= 16; p += 16) {
+        count += __builtin_popcount(sseMask(_mm_cmpeq_epi8(sseLoad(p), nl)));
+    }
+    return count + scalarCountNewlines(p, end);
+}
+
+size_t sse2FindNewlines(const char* p, const char* end, uint32_t* out) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    const char* q = p;
+    size_t count = 0;
+    for (; end - q >= 16; q += 16) {
+        unsigned hit = sseMask(_mm_cmpeq_epi8(sseLoad(q), nl));
+        count += emitBits(hit, static_cast<uint32_t>(q - p), out + count);
+    }
+    size_t tail = scalarFindNewlines(q, end, out + count);
+    for (size_t i = count; i < count + tail; ++i) out[i] += static_cast<uint32_t>(q - p);
+    return count + tail;
+}
+
+constexpr Kernels kSse2 = {
+    sse2SkipWhitespace, sse2FindLineEnd,   sse2FindStarOrNul,
+    sse2IdentifierEnd,  sse2DigitsEnd,     sse2CountNewlines,
+    sse2FindNewlines,
+};
+
+// ---------------------------------------------------------------------------
+// AVX2: 32 байта за шаг, включается только при поддержке процессором
+// ---------------------------------------------------------------------------
+
+#define CHARSCAN_AVX2 __attribute__((target("avx2")))
+
+CHARSCAN_AVX2 inline __m256i avxInRange(__m256i v, char lo, char span) {
+    __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(span)), t);
+}
+
+CHARSCAN_AVX2 inline __m256i avxSpace(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                           avxInRange(v, '\t', '\r' - '\t'));
+}
+
+CHARSCAN_AVX2 inline __m256i avxDigit(__m256i v) { return avxInRange(v, '0', 9); }
+
+CHARSCAN_AVX2 inline __m256i avxIdent(__m256i v) {
+    __m256i alpha = avxInRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 25);
+    __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(alpha, avxDigit(v)), under);
+}
+
+CHARSCAN_AVX2 inline unsigned avxMask(__m256i m) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(m));
+}
+
+CHARSCAN_AVX2 inline __m256i avxLoad(const char* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+CHARSCAN_AVX2 const char* avx2SkipWhitespace(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned miss = ~avxMask(avxSpace(avxLoad(p)));
+        if (miss) return p + __builtin_ctz(miss);
+    }
+    return sse2SkipWhitespace(p, end);
+}
+
+CHARSCAN_AVX2 const char* avx2FindLineEnd(const char* p, const char* end) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const __m256i nul = _mm256_setzero_si256();
+    for (; end - p >= 32; p += 32) {
+        __m256i v = avxLoad(p);
+        unsigned hit = avxMask(_mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, nul)));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return sse2FindLineEnd(p, end);
+}
+
+CHARSCAN_AVX2 const char* avx2FindStarOrNul(const char* p, const char* end) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i nul = _mm256_setzero_si256();
+    for (; end - p >= 32; p += 32) {
+        __m256i v = avxLoad(p);
+        unsigned hit = avxMask(_mm256_or_si256(_mm256_cmpeq_epi8(v, star), _mm256_cmpeq_epi8(v, nul)));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return sse2FindStarOrNul(p, end);
+}
+
+CHARSCAN_AVX2 const char* avx2IdentifierEnd(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned miss = ~avxMask(avxIdent(avxLoad(p)));
+        if (miss) return p + __builtin_ctz(miss);
+    }
+    return sse2IdentifierEnd(p, end);
+}
+
+CHARSCAN_AVX2 const char* avx2DigitsEnd(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned miss = ~avxMask(avxDigit(avxLoad(p)));
+        if (miss) return p + __builtin_ctz(miss);
+    }
+    return sse2DigitsEnd(p, end);
+}
+
+CHARSCAN_AVX2 size_t avx2CountNewlines(const char* p, const char* end) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    for (; end - p >= 32; p += 32) {
+        count += __builtin_popcount(avxMask(_mm256_cmpeq_epi8(avxLoad(p), nl)));
+    }
+    return count + sse2CountNewlines(p, end);
+}
+
+CHARSCAN_AVX2 size_t avx2FindNewlines(const char* p, const char* end, uint32_t* out) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const char* q = p;
+    size_t count = 0;
+    for (; end - q >= 32; q += 32) {
+        unsigned hit = avxMask(_mm256_cmpeq_epi8(avxLoad(q), nl));
+        count += emitBits(hit, static_cast<uint32_t>(q - p), out + count);
+    }
+    size_t tail = sse2FindNewlines(q, end, out + count);
+    for (size_t i = count; i < count + tail; ++i) out[i] += static_cast<uint32_t>(q - p);
+    return count + tail;
+}
+
+#undef CHARSCAN_AVX2
+
+constexpr Kernels kAvx2 = {
+    avx2SkipWhitespace, avx2FindLineEnd,   avx2FindStarOrNul,
+    avx2IdentifierEnd,  avx2DigitsEnd,     avx2CountNewlines,
+    avx2FindNewlines,
+};
+
+#endif  // CHARSCAN_X86
+
+Level detectLevel() {
+#ifdef CHARSCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Level::AVX2;
+    }
+    return Level::SSE2;
+#else
+    return Level::Scalar;
+#endif
+}
+
+const Kernels& kernelsFor(Level level) {
+    switch (level) {
+#ifdef CHARSCAN_X86
+        case Level::AVX2: return kAvx2;
+        case Level::SSE2: return kSse2;
+#endif
+        default: return kScalar;
+    }
+}
+
+Level& currentLevel() {
+    static Level level = detectLevel();
+    return level;
+}
+
+const Kernels*& currentKernels() {
+    static const Kernels* active = &kernelsFor(currentLevel());
+    return active;
+}
+
+}  // namespace
+
+const Kernels& kernels() {
+    return *currentKernels();
+}
+
+Level activeLevel() {
+    return currentLevel();
+}
+
+Level bestLevel() {
+    static const Level best = detectLevel();
+    return best;
+}
+
+void setLevel(Level level) {
+    if (static_cast<int>(level) > static_cast<int>(bestLevel())) {
+        level = bestLevel();
+    }
+    currentLevel() = level;
+    currentKernels() = &kernelsFor(level);
+}
+
+const char* findBlockCommentEnd(const char* p, const char* end) {
+    const Kernels& k = kernels();
+    while (true) {
+        p = k.findStarOrNul(p, end);
+        // '*' в самом конце ввода комментарий не закрывает
+        if (p == end || *p == '\0' || (p + 1 < end && p[1] == '/')) {
+            return p;
+        }
+        ++p;
+    }
+}
+
+}  // namespace charscan
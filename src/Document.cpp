@@ -0,0 +1,361 @@
+// Document.cpp
+#include "../include/Document.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include "../include/CharScan.h"
+
+namespace {
+
+// Мусор собирается, когда его больше, чем живых узлов, но не раньше
+constexpr size_t kCompactMinNodes = size_t{1} << 16;
+
+// Написание ключевого слова, которым начинается следующий кусок
+std::string_view keywordText(TokenType type) {
+    for (const auto& kw : kKeywords) {
+        if (kw.type == type) {
+            return kw.text;
+        }
+    }
+    return {};
+}
+
+// Границы кусков в тексте участка по токенам
+struct RegionScan {
+    // Начала кусков (первое - 0) и виды их первых токенов
+    std::vector<size_t> starts;
+    std::vector<TokenType> kinds;
+    // Участок начинается прямо с объявления верхнего уровня
+    bool leadingDeclaration = false;
+    // За участком начинается токен вне скобок, то есть граница следующего
+    // куска осталась границей; next - вид этого токена
+    bool closed = true;
+    TokenType next = TokenType::EndOfFile;
+};
+
+// Лексит text, а за ним - начало следующего куска nextText, пока не дойдёт
+// до его первого токена: только так видно, не слиплись ли они и не
+// продолжился ли в нём комментарий или строка
+RegionScan scanRegion(std::string_view text, std::string_view nextText, LexerBackend backend) {
+    std::string joined;
+    joined.reserve(text.size() + nextText.size());
+    joined.append(text);
+    joined.append(nextText);
+    // Нужны только границы, имена этого прохода выбрасываются
+    SymbolTable scratch;
+    Lexer lexer(SourceBuffer::fromString(std::move(joined)), backend, scratch);
+
+    RegionScan scan;
+    scan.starts.push_back(0);
+    scan.kinds.push_back(TokenType::EndOfFile);
+    size_t depth = 0;
+    for (bool first = true;; first = false) {
+        Token tok = lexer.next();
+        if (tok.type == TokenType::EndOfFile || tok.offset >= text.size()) {
+            scan.closed = nextText.empty() || (tok.offset == text.size() && depth == 0);
+            scan.next = tok.type;
+            return scan;
+        }
+        if (first) {
+            scan.leadingDeclaration = tok.offset == 0 && SyntaxAnalyzer::startsDeclaration(tok.type);
+            scan.kinds[0] = tok.type;
+        }
+        if (tok.type == TokenType::LBRACE) {
+            ++depth;
+        } else if (tok.type == TokenType::RBRACE) {
+            depth -= depth > 0;
+        } else if (depth == 0 && tok.offset != 0 && SyntaxAnalyzer::startsDeclaration(tok.type)) {
+            scan.starts.push_back(tok.offset);
+            scan.kinds.push_back(tok.type);
+        }
+    }
+}
+
+// Кодовых точек UTF-8 в text
+size_t codePoints(std::string_view text) {
+    size_t count = 0;
+    for (char c : text) {
+        count += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+}  // namespace
+
+Document::Document(std::string_view text, LexerBackend backend)
+    : backend_(backend), ownSymbols_(std::make_unique<SymbolTable>()), symbols_(ownSymbols_.get()) {
+    ast_.setRoot(ast_.add(NodeKind::Program, 0));
+    replace(0, 0, std::string(text));
+}
+
+Document::Document(std::string_view text, LexerBackend backend, SymbolTable& symbols)
+    : backend_(backend), symbols_(&symbols) {
+    ast_.setRoot(ast_.add(NodeKind::Program, 0));
+    replace(0, 0, std::string(text));
+}
+
+void Document::edit(const TextEdit& change) {
+    if (change.offset > size_ || change.length > size_ - change.offset) {
+        throw std::out_of_range("Document::edit: range is outside the text");
+    }
+    size_t end = change.offset + change.length;
+    size_t first = segmentAt(change.offset);
+    size_t last = segments_.empty() ? 0 : segmentAt(end > change.offset ? end - 1 : change.offset) + 1;
+
+    size_t regionStart = first < segments_.size() ? places_[first].start : size_;
+    std::string text;
+    for (size_t k = first; k < last; ++k) {
+        text.append(segments_[k].text());
+    }
+    text.replace(change.offset - regionStart, change.length, change.text);
+    replace(first, last, std::move(text));
+}
+
+std::string Document::text() const {
+    std::string out;
+    out.reserve(size_);
+    for (const Segment& seg : segments_) {
+        out.append(seg.text());
+    }
+    return out;
+}
+
+uint32_t Document::offsetOf(NodeId id) const {
+    for (size_t k = 0; k < segments_.size(); ++k) {
+        if (id >= segments_[k].firstNode && id < segments_[k].endNode) {
+            return static_cast<uint32_t>(places_[k].start + ast_[id].offset);
+        }
+    }
+    return ast_[id].offset;
+}
+
+std::vector<Diagnostic> Document::diagnostics() const {
+    std::vector<Diagnostic> out;
+    if (diagnosticCount_ == 0) {
+        return out;
+    }
+    out.reserve(diagnosticCount_);
+    for (size_t k = 0; k < places_.size(); ++k) {
+        const Place& place = places_[k];
+        if (place.diagnostics == 0) {
+            continue;
+        }
+        // Столбец начала куска: хвосты предыдущих кусков до перевода строки
+        size_t column = 1;
+        for (size_t j = k; j-- > 0;) {
+            column += segments_[j].tailColumns;
+            if (segments_[j].newlines != 0) {
+                break;
+            }
+        }
+        for (const Diagnostic& local : segments_[k].diagnostics) {
+            Diagnostic& d = out.emplace_back(local);
+            d.offset = static_cast<uint32_t>(place.start + local.offset);
+            d.line = static_cast<int>(place.line) + local.line - 1;
+            d.column = local.line == 1 ? static_cast<int>(column) + local.column - 1 : local.column;
+        }
+    }
+    return out;
+}
+
+// Участок расширяется, пока его начало не совпадёт с началом объявления
+// (или документа), а конец - с началом следующего куска вне скобок
+void Document::replace(size_t first, size_t last, std::string text) {
+    RegionScan scan;
+    // Участок перелексируется целиком на каждом шаге, поэтому вправо он растёт
+    // удвоением: незакрытая скобка стоит O(n), а не O(n^2). Лишние куски
+    // просто разрежутся заново по тем же границам.
+    size_t grow = 1;
+    for (;;) {
+        std::string_view nextText = last < segments_.size() ? segments_[last].text() : std::string_view();
+        scan = scanRegion(text, nextText, backend_);
+        // Разбор предыдущего куска видит первый токен участка: если тот
+        // сменился (let на var), кусок разбирается заново
+        if (first > 0 && (!scan.leadingDeclaration || segments_[first - 1].next != scan.kinds[0])) {
+            --first;
+            text.insert(0, segments_[first].text());
+        } else if (!scan.closed) {
+            for (size_t end = std::min(last + grow, segments_.size()); last < end; ++last) {
+                text.append(segments_[last].text());
+            }
+            grow *= 2;
+        } else {
+            break;
+        }
+    }
+
+    // Место участка - сразу за предыдущим куском, который не менялся
+    Place place;
+    if (first > 0) {
+        place.start = places_[first - 1].start + segments_[first - 1].text().size();
+        place.line = places_[first - 1].line + static_cast<uint32_t>(segments_[first - 1].newlines);
+    }
+    size_t oldSize = 0;
+    size_t oldNewlines = 0;
+    for (size_t k = first; k < last; ++k) {
+        liveNodes_ -= segments_[k].endNode - segments_[k].firstNode;
+        diagnosticCount_ -= segments_[k].diagnostics.size();
+        oldSize += segments_[k].text().size();
+        oldNewlines += segments_[k].newlines;
+    }
+
+    std::vector<Segment> fresh;
+    std::vector<Place> freshPlaces;
+    size_t newlines = 0;
+    for (size_t i = 0; i < scan.starts.size(); ++i) {
+        size_t begin = scan.starts[i];
+        size_t end = i + 1 < scan.starts.size() ? scan.starts[i + 1] : text.size();
+        if (begin == end) {
+            continue;  // пустой документ
+        }
+        TokenType next = i + 1 < scan.starts.size() ? scan.kinds[i + 1] : scan.next;
+        Segment& seg = fresh.emplace_back(build(std::string_view(text).substr(begin, end - begin), next));
+        diagnosticCount_ += seg.diagnostics.size();
+        freshPlaces.push_back({place.start + begin, place.line + static_cast<uint32_t>(newlines),
+                               static_cast<uint32_t>(seg.diagnostics.size())});
+        newlines += seg.newlines;
+    }
+
+    // Обычно правка не меняет числа кусков, и они заменяются на месте
+    if (fresh.size() == last - first) {
+        std::move(fresh.begin(), fresh.end(), segments_.begin() + first);
+        std::copy(freshPlaces.begin(), freshPlaces.end(), places_.begin() + first);
+    } else {
+        segments_.erase(segments_.begin() + first, segments_.begin() + last);
+        segments_.insert(segments_.begin() + first, std::make_move_iterator(fresh.begin()),
+                         std::make_move_iterator(fresh.end()));
+        places_.erase(places_.begin() + first, places_.begin() + last);
+        places_.insert(places_.begin() + first, freshPlaces.begin(), freshPlaces.end());
+    }
+    last = first + fresh.size();
+    // Сдвиги по модулю 2^64 и 2^32: так же верны и при укорочении текста
+    const size_t shift = text.size() - oldSize;
+    const uint32_t lineShift = static_cast<uint32_t>(newlines - oldNewlines);
+    if (shift != 0 || lineShift != 0) {
+        for (size_t k = last; k < places_.size(); ++k) {
+            places_[k].start += shift;
+            places_[k].line += lineShift;
+        }
+    }
+    size_ += shift;
+
+    link(first, last);
+    // Своя таблица имён пересобирается вместе с деревом по тому же правилу
+    const bool symbolGarbage =
+        ownSymbols_ && symbols_->size() > kCompactMinNodes && symbols_->size() > 2 * liveSymbols_;
+    if ((ast_.size() > kCompactMinNodes && ast_.size() > 2 * liveNodes_) || symbolGarbage) {
+        compact();
+    }
+}
+
+// Лексит и разбирает один кусок. next - первый токен следующего куска:
+// разбор видит его за концом куска так же, как при разборе целиком.
+Document::Segment Document::build(std::string_view text, TokenType next) {
+    Segment seg;
+    seg.next = next;
+    seg.lexer = std::make_unique<Lexer>(SourceBuffer::fromString(std::string(text)), backend_, *symbols_);
+    std::vector<Token> tokens = seg.lexer->tokenize();
+    size_t end = tokens.size() - 1;  // EndOfFile
+    if (next != TokenType::EndOfFile) {
+        tokens.insert(tokens.begin() + end, Token(next, keywordText(next), static_cast<uint32_t>(text.size())));
+    }
+    SyntaxAnalyzer parser(tokens, seg.lexer->sourceBuffer());
+    parser.analyzeAllUntil(end);
+
+    const Ast& local = parser.ast();
+    seg.firstNode = ast_.append(local);
+    seg.endNode = static_cast<NodeId>(ast_.size());
+    liveNodes_ += local.size();
+    NodeId statement = ast_[seg.firstNode + local.root()].firstChild;
+    seg.firstStatement = statement;
+    for (; statement != kNoNode; statement = ast_[statement].nextSibling) {
+        seg.lastStatement = statement;
+    }
+    seg.diagnostics = parser.diagnostics();
+
+    seg.newlines = charscan::countNewlines(text.data(), text.data() + text.size());
+    size_t lastNewline = text.rfind('\n');
+    seg.tailColumns = codePoints(lastNewline == std::string_view::npos ? text : text.substr(lastNewline + 1));
+    return seg;
+}
+
+void Document::link(size_t first, size_t last) {
+    // Последний оператор перед участком: к нему цепляется первый оператор
+    // участка (или к корню, если участок в начале)
+    NodeId prev = kNoNode;
+    for (size_t k = first; k-- > 0;) {
+        if (segments_[k].lastStatement != kNoNode) {
+            prev = segments_[k].lastStatement;
+            break;
+        }
+    }
+    auto attach = [&](NodeId statement) {
+        if (prev == kNoNode) {
+            ast_[ast_.root()].firstChild = statement;
+        } else {
+            ast_[prev].nextSibling = statement;
+        }
+    };
+    for (size_t k = first; k < last; ++k) {
+        if (segments_[k].firstStatement != kNoNode) {
+            attach(segments_[k].firstStatement);
+            prev = segments_[k].lastStatement;
+        }
+    }
+    NodeId next = kNoNode;
+    for (size_t k = last; k < segments_.size() && next == kNoNode; ++k) {
+        next = segments_[k].firstStatement;
+    }
+    attach(next);
+}
+
+// Переносит узлы живых кусков в новое дерево подряд
+void Document::compact() {
+    Ast fresh;
+    fresh.setRoot(fresh.add(NodeKind::Program, 0));
+    for (Segment& seg : segments_) {
+        NodeId base = fresh.append(ast_, seg.firstNode, seg.endNode);
+        auto relocate = [&](NodeId id) { return id == kNoNode ? kNoNode : id - seg.firstNode + base; };
+        seg.firstStatement = relocate(seg.firstStatement);
+        seg.lastStatement = relocate(seg.lastStatement);
+        seg.endNode = base + (seg.endNode - seg.firstNode);
+        seg.firstNode = base;
+    }
+    ast_ = std::move(fresh);
+    link(0, segments_.size());
+    if (ownSymbols_) {
+        compactSymbols();
+    }
+}
+
+// Оставляет в своей таблице только имена живых узлов. Номера выдаются
+// заново по порядку первой встречи в дереве, узлы переводятся на них.
+void Document::compactSymbols() {
+    SymbolTable live;
+    std::vector<SymbolId> remap(symbols_->size(), kNoSymbol);
+    for (NodeId id = 0; id < ast_.size(); ++id) {
+        SymbolId& symbol = ast_[id].symbol;
+        if (symbol == kNoSymbol) {
+            continue;
+        }
+        if (remap[symbol] == kNoSymbol) {
+            remap[symbol] = live.intern(symbols_->name(symbol));
+        }
+        symbol = remap[symbol];
+    }
+    // Имена переносятся в ту же таблицу, на которую ссылаются лексеры кусков:
+    // после clear() они получают те же номера, что в live
+    symbols_->clear();
+    for (SymbolId id = 0; id < live.size(); ++id) {
+        symbols_->intern(live.name(id));
+    }
+    liveSymbols_ = live.size();
+}
+
+size_t Document::segmentAt(size_t offset) const {
+    auto it = std::upper_bound(places_.begin(), places_.end(), offset,
+                               [](size_t value, const Place& place) { return value < place.start; });
+    return it == places_.begin() ? 0 : static_cast<size_t>(it - places_.begin()) - 1;
+}
@@ -1,6 +1,13 @@
 // Lexer.cpp
 #include "../include/Lexer.h"
 
+#include <algorithm>
+#include <charconv>
+
+#include "../include/CharScan.h"
+#include "../include/LexerTries.h"
+#include "../include/OperatorDfa.h"
+
 // Пропускает текущий символ и переходит к следующему
 void Lexer::readChar() {
     if (readPosition >= input.size()) {
@@ -10,12 +17,17 @@ void Lexer::readChar() {
     }
     position = readPosition;
     readPosition++;
-    if (currentChar == '\n') {
-        line++;
-        column = 0;
-    } else {
-        column++;
+}
+
+// Перескакивает сразу на позицию target с тем же результатом, что и
+// (target - position) вызовов readChar()
+void Lexer::advanceTo(size_t target) {
+    if (target <= position) {
+        return;
     }
+    position = target;
+    readPosition = target + 1;
+    currentChar = target < input.size() ? input[target] : '\0';
 }
 
 // Возвращает следующий символ без его пропуска
@@ -29,217 +41,311 @@ char Lexer::peekChar() {
 
 // Пропускает пробельные символы (пробелы, табуляции, переводы строк)
 void Lexer::skipWhitespace() {
-    while (isspace(currentChar)) {
-        readChar();
+    if (isspace(currentChar)) {
+        const char* base = input.data();
+        advanceTo(charscan::skipWhitespace(base + position, base + input.size()) - base);
     }
 }
 
 // Пропускает комментарии (однострочные // и многострочные /* */)
 void Lexer::skipComment() {
     if (currentChar == '/') {
+        const char* base = input.data();
+        const char* end = base + input.size();
         char next = peekChar();
         if (next == '/') {
-            // Однострочный комментарий
-            while (currentChar != '\n' && currentChar != '\0') {
-                readChar();
-            }
+            // Однострочный комментарий: до '\n' или '\0'
+            advanceTo(charscan::findLineEnd(base + position, end) - base);
         } else if (next == '*') {
             // Многострочный комментарий
             readChar(); // Пропустить '/'
             readChar(); // Пропустить '*'
-            while (true) {
-                if (currentChar == '*' && peekChar() == '/') {
-                    readChar(); // Пропустить '*'
-                    readChar(); // Пропустить '/'
-                    break;
-                } else if (currentChar == '\0') {
-                    // Ошибка: не закрыт многострочный комментарий
-                    break;
-                } else {
-                    readChar();
-                }
+            const char* close = charscan::findBlockCommentEnd(base + position, end);
+            if (close != end && *close == '*') {
+                advanceTo(close - base + 2); // Пропустить "*/"
+            } else {
+                // Ошибка: не закрыт многострочный комментарий
+                advanceTo(close - base);
             }
         }
     }
 }
 
+// Возвращает следующий значимый токен, пропуская пробелы и комментарии.
+// После конца ввода всегда возвращает EndOfFile.
+Token Lexer::next() {
+    skipWhitespace();
+
+    // Проверка на комментарии (несколько подряд идущих тоже пропускаются)
+    while (currentChar == '/' && (peekChar() == '/' || peekChar() == '*')) {
+        skipComment();
+        skipWhitespace();
+    }
+
+    size_t start = position;
+    Token tok = nextToken();
+    tok.offset = static_cast<uint32_t>(std::min(start, input.size()));
+    return tok;
+}
+
 // Основной метод для токенизации входного кода
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
     Token tok;
 
     while (true) {
-        skipWhitespace();
-
-        // Проверка на комментарии
-        if (currentChar == '/') {
-            char next = peekChar();
-            if (next == '/' || next == '*') {
-                skipComment();
-                skipWhitespace();
-                if (currentChar == '\0') {
-                    break;
-                }
-            }
-        }
-
-        tok = nextToken();
+        tok = next();
         tokens.push_back(tok);
         if (tok.type == TokenType::EndOfFile) {
             break;
         }
     }
+    // Весь ввод прочитан, номера имён больше не понадобятся
+    interned = {};
 
     return tokens;
 }
 
-// Генерация следующего токена
+// Номер имени из ввода; в общую таблицу обращаемся только при первой
+// встрече имени
+SymbolId Lexer::intern(std::string_view name) {
+    auto [it, inserted] = interned.try_emplace(name, kNoSymbol);
+    if (inserted) {
+        it->second = symbols->intern(name);
+    }
+    return it->second;
+}
+
+// Генерация следующего токена выбранным способом
 Token Lexer::nextToken() {
     skipWhitespace();
+    switch (backend) {
+        case LexerBackend::Table: return nextTokenTable();
+        case LexerBackend::Trie: return nextTokenTrie();
+        default: return nextTokenSwitch();
+    }
+}
 
+// Табличный разбор: класс первого символа выбирает ветку, операторы и
+// разделители распознаются автоматом, построенным по kOperators
+Token Lexer::nextTokenTable() {
+    static const OperatorDfa& dfa = OperatorDfa::instance();
+
+    switch (dfa.kind(currentChar)) {
+        case CharKind::IdentStart:
+            return identifier();
+        case CharKind::Digit:
+            return number();
+        case CharKind::Quote:
+            return stringLiteral();
+        case CharKind::End:
+            // Позиция не сдвигается: повторные вызовы снова дают EndOfFile
+            return Token(TokenType::EndOfFile, "");
+        case CharKind::Operator: {
+            const char* base = input.data();
+            OperatorDfa::Match match = dfa.match(base + position, base + input.size());
+            if (match.length != 0) {
+                Token tok(match.type, input.substr(position, match.length));
+                advanceTo(position + match.length);
+                return tok;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    // Символ, с которого не начинается ни один токен
+    Token tok(TokenType::Unknown, input.substr(position, 1));
+    readChar();
+    return tok;
+}
+
+// Разбор по префиксным деревьям: ключевое слово распознаётся тем же проходом,
+// что и начало идентификатора, оператор - самым длинным совпадением
+Token Lexer::nextTokenTrie() {
+    static const OperatorDfa& dfa = OperatorDfa::instance();
+    static const LexerTries& tries = LexerTries::instance();
+    const char* base = input.data();
+    const char* end = base + input.size();
+
+    switch (dfa.kind(currentChar)) {
+        case CharKind::IdentStart: {
+            size_t startPos = position;
+            Trie::Match kw = tries.keywords().LongestMatch(base + position, end);
+            // Идентификатор дочитывается с места, где остановилось дерево
+            size_t identEnd = charscan::identifierEnd(base + position + kw.length, end) - base;
+            bool isKeyword = kw.length != 0 && identEnd == startPos + kw.length;
+            advanceTo(identEnd);
+            return word(startPos, isKeyword ? static_cast<TokenType>(kw.value) : TokenType::Identifier);
+        }
+        case CharKind::Digit:
+            return number();
+        case CharKind::Quote:
+            return stringLiteral();
+        case CharKind::End:
+            // Позиция не сдвигается: повторные вызовы снова дают EndOfFile
+            return Token(TokenType::EndOfFile, "");
+        case CharKind::Operator: {
+            Trie::Match op = tries.operators().LongestMatch(base + position, end);
+            if (op.length != 0) {
+                Token tok(static_cast<TokenType>(op.value), input.substr(position, op.length));
+                advanceTo(position + op.length);
+                return tok;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    // Символ, с которого не начинается ни один токен
+    Token tok(TokenType::Unknown, input.substr(position, 1));
+    readChar();
+    return tok;
+}
+
+// Разбор через switch по текущему символу (исходная реализация)
+Token Lexer::nextTokenSwitch() {
     Token tok;
-    tok.line = line;
-    tok.column = column;
 
     switch (currentChar) {
         // Разделители и операторы
         case '=':
             if (peekChar() == '=') {
-                char prev = currentChar;
                 readChar();
                 tok.type = TokenType::OP_EQUAL;
-                tok.value = std::string(1, prev) + std::string(1, currentChar);
+                tok.value = input.substr(position - 1, 2);
+            } else if (peekChar() == '>') {
+                readChar();
+                tok.type = TokenType::OP_DOUBLE_ARROW;
+                tok.value = input.substr(position - 1, 2);
             } else {
                 tok.type = TokenType::OP_ASSIGN;
-                tok.value = "=";
+                tok.value = input.substr(position, 1);
             }
             break;
         case '+':
             tok.type = TokenType::OP_PLUS;
-            tok.value = "+";
+            tok.value = input.substr(position, 1);
             break;
         case '-':
             if (peekChar() == '>') {
-                char prev = currentChar;
                 readChar();
                 tok.type = TokenType::OP_ARROW;
-                tok.value = std::string(1, prev) + std::string(1, currentChar);
+                tok.value = input.substr(position - 1, 2);
             } else {
                 tok.type = TokenType::OP_MINUS;
-                tok.value = "-";
+                tok.value = input.substr(position, 1);
             }
             break;
         case '*':
             tok.type = TokenType::OP_MULTIPLY;
-            tok.value = "*";
+            tok.value = input.substr(position, 1);
             break;
         case '/':
             tok.type = TokenType::OP_DIVIDE;
-            tok.value = "/";
+            tok.value = input.substr(position, 1);
             break;
         case '%':
             tok.type = TokenType::OP_MODULO;
-            tok.value = "%";
+            tok.value = input.substr(position, 1);
             break;
         case '!':
             if (peekChar() == '=') {
-                char prev = currentChar;
                 readChar();
                 tok.type = TokenType::OP_NOT_EQUAL;
-                tok.value = std::string(1, prev) + std::string(1, currentChar);
+                tok.value = input.substr(position - 1, 2);
             } else {
                 tok.type = TokenType::OP_NOT;
-                tok.value = "!";
+                tok.value = input.substr(position, 1);
             }
             break;
         case '<':
             if (peekChar() == '=') {
-                char prev = currentChar;
                 readChar();
                 tok.type = TokenType::OP_LESS_EQUAL;
-                tok.value = std::string(1, prev) + std::string(1, currentChar);
+                tok.value = input.substr(position - 1, 2);
             } else {
                 tok.type = TokenType::OP_LESS;
-                tok.value = "<";
+                tok.value = input.substr(position, 1);
             }
             break;
         case '>':
             if (peekChar() == '=') {
-                char prev = currentChar;
                 readChar();
                 tok.type = TokenType::OP_GREATER_EQUAL;
-                tok.value = std::string(1, prev) + std::string(1, currentChar);
+                tok.value = input.substr(position - 1, 2);
             } else {
                 tok.type = TokenType::OP_GREATER;
-                tok.value = ">";
+                tok.value = input.substr(position, 1);
             }
             break;
         case '&':
             if (peekChar() == '&') {
-                char prev = currentChar;
                 readChar();
                 tok.type = TokenType::OP_AND;
-                tok.value = std::string(1, prev) + std::string(1, currentChar);
+                tok.value = input.substr(position - 1, 2);
             } else {
                 tok.type = TokenType::Unknown;
-                tok.value = "&";
+                tok.value = input.substr(position, 1);
             }
             break;
         case '|':
             if (peekChar() == '|') {
-                char prev = currentChar;
                 readChar();
                 tok.type = TokenType::OP_OR;
-                tok.value = std::string(1, prev) + std::string(1, currentChar);
+                tok.value = input.substr(position - 1, 2);
             } else {
                 tok.type = TokenType::Unknown;
-                tok.value = "|";
+                tok.value = input.substr(position, 1);
             }
             break;
         case '(':
             tok.type = TokenType::LPAREN;
-            tok.value = "(";
+            tok.value = input.substr(position, 1);
             break;
         case ')':
             tok.type = TokenType::RPAREN;
-            tok.value = ")";
+            tok.value = input.substr(position, 1);
             break;
         case '{':
             tok.type = TokenType::LBRACE;
-            tok.value = "{";
+            tok.value = input.substr(position, 1);
             break;
         case '}':
             tok.type = TokenType::RBRACE;
-            tok.value = "}";
+            tok.value = input.substr(position, 1);
             break;
         case '[':
             tok.type = TokenType::LBRACKET;
-            tok.value = "[";
+            tok.value = input.substr(position, 1);
             break;
         case ']':
             tok.type = TokenType::RBRACKET;
-            tok.value = "]";
+            tok.value = input.substr(position, 1);
             break;
         case ',':
             tok.type = TokenType::COMMA;
-            tok.value = ",";
+            tok.value = input.substr(position, 1);
             break;
         case ':':
             tok.type = TokenType::COLON;
-            tok.value = ":";
+            tok.value = input.substr(position, 1);
             break;
         case ';':
             tok.type = TokenType::SEMICOLON;
-            tok.value = ";";
+            tok.value = input.substr(position, 1);
             break;
         case '.':
             tok.type = TokenType::DOT;
-            tok.value = ".";
+            tok.value = input.substr(position, 1);
             break;
         case '\0':
+            // Позиция не сдвигается: повторные вызовы снова дают EndOfFile
             tok.type = TokenType::EndOfFile;
             tok.value = "";
-            break;
+            return tok;
         case '"':
             tok = stringLiteral();
             return tok;
@@ -252,7 +358,7 @@ Token Lexer::nextToken() {
                 return tok;
             } else {
                 tok.type = TokenType::Unknown;
-                tok.value = std::string(1, currentChar);
+                tok.value = input.substr(position, 1);
             }
     }
 
@@ -263,37 +369,89 @@ Token Lexer::nextToken() {
 // Обработка идентификаторов и ключевых слов
 Token Lexer::identifier() {
     size_t startPos = position;
-    int startColumn = column;
-    while (isalnum(currentChar) || currentChar == '_') {
-        readChar();
-    }
-    std::string ident = input.substr(startPos, readPosition - position - 1);
-    TokenType type = checkKeyword(ident);
+    const char* base = input.data();
+    advanceTo(charscan::identifierEnd(base + position, base + input.size()) - base);
+    return word(startPos, checkKeyword(input.substr(startPos, position - startPos)));
+}
+
+// Токен для уже прочитанного слова [startPos, position): ключевого слова
+// типа type, булева литерала или идентификатора
+Token Lexer::word(size_t startPos, TokenType type) {
+    std::string_view ident = input.substr(startPos, position - startPos);
     if (type == TokenType::KW_TRUE || type == TokenType::KW_FALSE) {
-        return Token(TokenType::BooleanLiteral, ident, line, startColumn);
+        Token tok(TokenType::BooleanLiteral, ident);
+        tok.boolValue = type == TokenType::KW_TRUE;
+        return tok;
+    }
+    Token tok(type, ident);
+    if (type == TokenType::Identifier) {
+        tok.symbol = intern(ident);
     }
-    return Token(type, ident, line, startColumn);
+    return tok;
 }
 
-// Обработка числовых литералов (целые числа)
+// Обработка числовых литералов: цифры [. цифры] [e [+-] цифры].
+// Значение раскодируется сразу; число, не помещающееся в int64_t или
+// double, становится токеном Unknown.
 Token Lexer::number() {
     size_t startPos = position;
-    int startColumn = column;
-    while (isdigit(currentChar)) {
-        readChar();
+    const char* base = input.data();
+    const char* end = base + input.size();
+    auto digitAt = [&](size_t i) { return i < input.size() && isdigit(static_cast<unsigned char>(input[i])); };
+
+    size_t pos = charscan::digitsEnd(base + position, end) - base;
+    bool isFloat = false;
+    // Дробная часть: точка считается частью числа, только если за ней цифра
+    if (pos < input.size() && input[pos] == '.' && digitAt(pos + 1)) {
+        isFloat = true;
+        pos = charscan::digitsEnd(base + pos + 1, end) - base;
+    }
+    // Порядок: e10, E+3, e-7
+    if (pos < input.size() && (input[pos] | 0x20) == 'e') {
+        size_t digits = pos + 1;
+        if (digits < input.size() && (input[digits] == '+' || input[digits] == '-')) {
+            ++digits;
+        }
+        if (digitAt(digits)) {
+            isFloat = true;
+            pos = charscan::digitsEnd(base + digits, end) - base;
+        }
     }
-    std::string numStr = input.substr(startPos, readPosition - position - 1);
-    return Token(TokenType::IntegerLiteral, numStr, line, startColumn);
+    advanceTo(pos);
+
+    std::string_view numStr = input.substr(startPos, position - startPos);
+    const char* first = numStr.data();
+    const char* last = first + numStr.size();
+    Token tok(isFloat ? TokenType::FloatLiteral : TokenType::IntegerLiteral, numStr);
+    std::from_chars_result result = isFloat ? std::from_chars(first, last, tok.floatValue)
+                                            : std::from_chars(first, last, tok.intValue);
+    if (result.ec != std::errc()) {
+        tok.type = TokenType::Unknown;
+        tok.intValue = 0;
+    }
+    return tok;
+}
+
+// Сохраняет строку, которой нет в исходном тексте, и возвращает её срез
+std::string_view Lexer::storeDecoded(std::string str) {
+    decoded.push_back(std::move(str));
+    return decoded.back();
 }
 
 // Обработка строковых литералов
 Token Lexer::stringLiteral() {
-    int startColumn = column;
     readChar(); // Пропустить начальную кавычку
     size_t startPos = position;
+    // Пока нет escape-последовательностей, значение - срез исходного текста,
+    // копия строится только при первой встреченной '\\'
+    bool hasEscapes = false;
     std::string str;
     while (currentChar != '"' && currentChar != '\0') {
         if (currentChar == '\\') {
+            if (!hasEscapes) {
+                hasEscapes = true;
+                str.assign(input.substr(startPos, position - startPos));
+            }
             readChar();
             switch (currentChar) {
                 case 'n': str += '\n'; break;
@@ -303,18 +461,22 @@ Token Lexer::stringLiteral() {
                 // Добавьте другие управляющие последовательности по необходимости
                 default: str += currentChar; break;
             }
-        } else {
+        } else if (hasEscapes) {
             str += currentChar;
         }
         readChar();
     }
-    readChar(); // Пропустить закрывающую кавычку
-    return Token(TokenType::StringLiteral, str, line, startColumn);
+    std::string_view value = hasEscapes
+                                 ? storeDecoded(std::move(str))
+                                 : input.substr(startPos, position - startPos);
+    if (currentChar == '"') {
+        readChar(); // Пропустить закрывающую кавычку
+    }
+    return Token(TokenType::StringLiteral, value);
 }
 
 // Обработка списковых литералов [1, 2, 3]
 Token Lexer::listLiteral() {
-    int startColumn = column;
     std::string listStr;
     listStr += currentChar; // Добавить '['
     readChar(); // Пропустить '['
@@ -322,7 +484,7 @@ Token Lexer::listLiteral() {
     while (currentChar != ']' && currentChar != '\0') {
         if (currentChar == '"') {
             Token strTok = stringLiteral();
-            listStr += "\"" + strTok.value + "\"";
+            listStr.append("\"").append(strTok.value).append("\"");
             continue;
         }
         listStr += currentChar;
@@ -334,12 +496,11 @@ Token Lexer::listLiteral() {
         readChar(); // Пропустить ']'
     }
 
-    return Token(TokenType::ListLiteral, listStr, line, startColumn);
+    return Token(TokenType::ListLiteral, storeDecoded(std::move(listStr)));
 }
 
 // Обработка объектных литералов { "key": "value" }
 Token Lexer::objectLiteral() {
-    int startColumn = column;
     std::string objStr;
     objStr += currentChar; // Добавить '{'
     readChar(); // Пропустить '{'
@@ -347,7 +508,7 @@ Token Lexer::objectLiteral() {
     while (currentChar != '}' && currentChar != '\0') {
         if (currentChar == '"') {
             Token strTok = stringLiteral();
-            objStr += "\"" + strTok.value + "\"";
+            objStr.append("\"").append(strTok.value).append("\"");
             continue;
         }
         objStr += currentChar;
@@ -359,5 +520,5 @@ Token Lexer::objectLiteral() {
         readChar(); // Пропустить '}'
     }
 
-    return Token(TokenType::ObjectLiteral, objStr, line, startColumn);
+    return Token(TokenType::ObjectLiteral, storeDecoded(std::move(objStr)));
 }
@@ -0,0 +1,176 @@
+// LexerParallel.cpp
+// Параллельная токенизация: предварительный проход ищет безопасные точки
+// разреза, затем куски лексятся независимо.
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "../include/Lexer.h"
+
+namespace {
+
+// Состояния предварительного прохода. Повторяют то, как лексер пропускает
+// строки и комментарии, включая незавершённые двухсимвольные переходы
+// на границе куска ('/' перед '/' или '*', '\' в строке, '*' перед '/').
+enum ScanState : uint8_t {
+    Code,
+    CodeSlash,
+    String,
+    StringEscape,
+    LineComment,
+    BlockComment,
+    BlockStar,
+    kStateCount,
+};
+
+enum ByteClass : uint8_t {
+    Other,
+    Quote,
+    Slash,
+    Star,
+    Backslash,
+    Newline,
+    kClassCount,
+};
+
+constexpr ScanState kTransitions[kStateCount][kClassCount] = {
+    //              Other         Quote         Slash        Star          Backslash     Newline
+    /* Code */     {Code,         String,       CodeSlash,   Code,         Code,         Code},
+    /* CodeSlash */{Code,         String,       LineComment, BlockComment, Code,         Code},
+    /* String */   {String,       Code,         String,      String,       StringEscape, String},
+    /* Escape */   {String,       String,       String,      String,       String,       String},
+    /* Line */     {LineComment,  LineComment,  LineComment, LineComment,  LineComment,  Code},
+    /* Block */    {BlockComment, BlockComment, BlockComment, BlockStar,   BlockComment, BlockComment},
+    /* Star */     {BlockComment, BlockComment, Code,        BlockStar,    BlockComment, BlockComment},
+};
+
+constexpr auto kByteClasses = [] {
+    std::array<ByteClass, 256> classes{};
+    classes['"'] = Quote;
+    classes['/'] = Slash;
+    classes['*'] = Star;
+    classes['\\'] = Backslash;
+    classes['\n'] = Newline;
+    return classes;
+}();
+
+struct ChunkScan {
+    ScanState endState = Code;
+    // Позиция сразу после первого '\n', за которым состояние - Code;
+    // SIZE_MAX, если в куске такой нет
+    size_t split = SIZE_MAX;
+};
+
+// Прогоняет автомат по [begin, end) из состояния state
+ChunkScan scanChunk(const char* base, size_t begin, size_t end, ScanState state) {
+    ChunkScan result;
+    for (size_t i = begin; i < end; ++i) {
+        ByteClass cls = kByteClasses[static_cast<unsigned char>(base[i])];
+        state = kTransitions[state][cls];
+        if (cls == Newline && state == Code && result.split == SIZE_MAX) {
+            result.split = i + 1;
+        }
+    }
+    result.endState = state;
+    return result;
+}
+
+// Куски меньше этого размера выгоднее лексить одним потоком
+constexpr size_t kMinChunkSize = 256 * 1024;
+
+}  // namespace
+
+std::vector<Token> Lexer::tokenizeParallel(ThreadPool& pool) {
+    const char* base = input.data();
+    const size_t size = input.size();
+
+    // '\0' лексер считает концом ввода - такой файл лексим последовательно.
+    // Так же и лексер, который уже что-то прочитал.
+    size_t chunkCount = std::min(pool.size() * 4, size / kMinChunkSize);
+    if (chunkCount < 2 || position != 0 || std::memchr(base, '\0', size) != nullptr) {
+        return tokenize();
+    }
+    const size_t chunkSize = size / chunkCount;
+    auto chunkBegin = [&](size_t j) { return j * chunkSize; };
+    auto chunkEnd = [&](size_t j) { return j + 1 == chunkCount ? size : (j + 1) * chunkSize; };
+
+    // 1. Спекулятивно: каждый кусок сканируется так, будто начинается в коде
+    std::vector<ChunkScan> scans(chunkCount);
+    pool.parallelFor(chunkCount, [&](size_t j) {
+        scans[j] = scanChunk(base, chunkBegin(j), chunkEnd(j), Code);
+    });
+
+    // 2. Последовательно уточняем начальные состояния. Если предположение
+    // не подтвердилось (строка или комментарий пересекают границу куска),
+    // кусок пересканируется из настоящего состояния.
+    std::vector<size_t> splits = {0};
+    ScanState state = Code;
+    for (size_t j = 0; j < chunkCount; ++j) {
+        if (state != Code) {
+            scans[j] = scanChunk(base, chunkBegin(j), chunkEnd(j), state);
+        }
+        if (j != 0 && scans[j].split != SIZE_MAX && scans[j].split < size) {
+            splits.push_back(scans[j].split);
+        }
+        state = scans[j].endState;
+    }
+    splits.push_back(size);
+    const size_t segmentCount = splits.size() - 1;
+
+    // 3. Лексим сегменты; EndOfFile остаётся только у последнего.
+    // Идентификаторы сегмента интернируются в его собственную таблицу,
+    // чтобы потоки не соперничали за общую.
+    std::vector<std::unique_ptr<SymbolTable>> localSymbols(segmentCount);
+    std::vector<Lexer> lexers;
+    lexers.reserve(segmentCount);
+    for (size_t k = 0; k < segmentCount; ++k) {
+        localSymbols[k] = std::make_unique<SymbolTable>();
+        lexers.push_back(Lexer(source, backend, *localSymbols[k], splits[k], splits[k + 1]));
+    }
+    std::vector<std::vector<Token>> parts(segmentCount);
+    pool.parallelFor(segmentCount, [&](size_t k) {
+        parts[k] = lexers[k].tokenize();
+        if (k + 1 != segmentCount) {
+            parts[k].pop_back();
+        }
+    });
+
+    // 4. Склейка в исходном порядке
+    std::vector<size_t> offsets(segmentCount + 1, 0);
+    for (size_t k = 0; k < segmentCount; ++k) {
+        offsets[k + 1] = offsets[k] + parts[k].size();
+    }
+    // Номера имён сегментов переводятся в номера общей таблицы; в неё
+    // имена добавляются по порядку сегментов, как при tokenize()
+    std::vector<std::vector<SymbolId>> remaps(segmentCount);
+    for (size_t k = 0; k < segmentCount; ++k) {
+        const SymbolTable& local = *localSymbols[k];
+        remaps[k].resize(local.size());
+        for (SymbolId id = 0; id < local.size(); ++id) {
+            remaps[k][id] = symbols->intern(local.name(id));
+        }
+    }
+    std::vector<Token> tokens(offsets.back());
+    pool.parallelFor(segmentCount, [&](size_t k) {
+        auto out = tokens.begin() + offsets[k];
+        for (const Token& tok : parts[k]) {
+            *out = tok;
+            if (tok.symbol != kNoSymbol) {
+                out->symbol = remaps[k][tok.symbol];
+            }
+            ++out;
+        }
+    });
+
+    // Раскодированные литералы переходят к этому лексеру вместе с токенами
+    for (auto& lexer : lexers) {
+        decoded.splice(decoded.end(), lexer.decoded);
+    }
+    // Сам лексер оказывается в конце ввода, как после tokenize()
+    const Lexer& last = lexers.back();
+    position = last.position;
+    readPosition = last.readPosition;
+    currentChar = last.currentChar;
+    return tokens;
+}
@@ -0,0 +1,106 @@
+// LexerTries.cpp
+#include "../include/LexerTries.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+#include "../include/TokenType.h"
+
+#ifndef ELANG_KEYWORDS_FILE
+#define ELANG_KEYWORDS_FILE "config/keywords.txt"
+#endif
+
+#ifndef ELANG_TRIE_CACHE_DIR
+#define ELANG_TRIE_CACHE_DIR ""
+#endif
+
+namespace {
+
+// Отпечаток встроенной таблицы: образ устаревает и при её изменении
+template <typename Table>
+uint64_t hashTable(const Table& table, uint64_t hash) {
+    for (const auto& entry : table) {
+        uint32_t type = static_cast<uint32_t>(entry.type);
+        hash = Trie::Hash(entry.text, hash);
+        hash = Trie::Hash({reinterpret_cast<const char*>(&type), sizeof type}, hash);
+    }
+    return hash;
+}
+
+// Дерево из образа в cacheDir, а если образа нет или он устарел - построенное
+// build и сохранённое туда для следующих запусков
+template <typename BuildFn>
+Trie loadOrBuild(const std::string& cacheDir, const char* name, uint64_t sourceHash, BuildFn build) {
+    std::string path = cacheDir.empty() ? std::string() : cacheDir + "/" + name;
+    if (!path.empty()) {
+        if (std::optional<Trie> cached = Trie::Load(path, sourceHash)) {
+            return std::move(*cached);
+        }
+    }
+    Trie trie;
+    build(trie);
+    trie.Build();
+    if (!path.empty()) {
+        try {
+            trie.Save(path, sourceHash);
+        } catch (const std::runtime_error&) {
+            // Каталог только для чтения: работаем без кэша
+        }
+    }
+    return trie;
+}
+
+}  // namespace
+
+std::string LexerTries::defaultKeywordsPath() {
+    if (const char* path = std::getenv("ELANG_KEYWORDS")) {
+        return path;
+    }
+    return ELANG_KEYWORDS_FILE;
+}
+
+std::string LexerTries::defaultCacheDir() {
+    if (const char* dir = std::getenv("ELANG_TRIE_CACHE")) {
+        return dir;
+    }
+    return ELANG_TRIE_CACHE_DIR;
+}
+
+const LexerTries& LexerTries::instance() {
+    static const LexerTries tries(defaultKeywordsPath(), defaultCacheDir());
+    return tries;
+}
+
+LexerTries::LexerTries(const std::string& keywordsPath, const std::string& cacheDir) {
+    std::ifstream in(keywordsPath, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    uint64_t keywordsHash = hashTable(kKeywords, Trie::Hash(text));
+    keywords_ = loadOrBuild(cacheDir, "keywords.trie", keywordsHash, [&](Trie& trie) {
+        std::string_view rest = text;
+        while (!rest.empty()) {
+            size_t eol = rest.find('\n');
+            std::string_view word = rest.substr(0, eol);
+            rest.remove_prefix(eol == std::string_view::npos ? rest.size() : eol + 1);
+            if (!word.empty() && word.back() == '\r') {
+                word.remove_suffix(1);
+            }
+            TokenType type = checkKeyword(word);
+            if (type != TokenType::Identifier) {
+                trie.AddString(word, static_cast<uint32_t>(type));
+            }
+        }
+        for (const auto& kw : kKeywords) {
+            trie.AddString(kw.text, static_cast<uint32_t>(kw.type));
+        }
+    });
+
+    operators_ = loadOrBuild(cacheDir, "operators.trie", hashTable(kOperators, Trie::Hash({})),
+                             [](Trie& trie) {
+                                 for (const auto& op : kOperators) {
+                                     trie.AddString(op.text, static_cast<uint32_t>(op.type));
+                                 }
+                             });
+}
@@ -0,0 +1,48 @@
+// OperatorDfa.cpp
+#include "../include/OperatorDfa.h"
+
+// Единственный экземпляр автомата, строится при первом обращении
+const OperatorDfa& OperatorDfa::instance() {
+    static const OperatorDfa dfa;
+    return dfa;
+}
+
+OperatorDfa::OperatorDfa() {
+    // Классы первых символов токенов
+    kinds_.fill(CharKind::Other);
+    for (unsigned char c : std::string_view(" \t\n\v\f\r")) kinds_[c] = CharKind::Space;
+    for (int c = 'a'; c <= 'z'; ++c) kinds_[c] = CharKind::IdentStart;
+    for (int c = 'A'; c <= 'Z'; ++c) kinds_[c] = CharKind::IdentStart;
+    kinds_['_'] = CharKind::IdentStart;
+    for (int c = '0'; c <= '9'; ++c) kinds_[c] = CharKind::Digit;
+    kinds_['"'] = CharKind::Quote;
+    kinds_[0] = CharKind::End;
+
+    // Сжатие алфавита: свой класс для каждого символа операторов
+    for (const auto& op : kOperators) {
+        for (unsigned char c : op.text) {
+            if (classes_[c] == 0) {
+                classes_[c] = static_cast<uint8_t>(classCount_++);
+            }
+        }
+        kinds_[static_cast<unsigned char>(op.text.front())] = CharKind::Operator;
+    }
+
+    // Состояния 0 (тупик) и 1 (начальное); остальные добавляются как узлы
+    // бора из строк операторов. Все переходы по умолчанию ведут в тупик.
+    accept_.assign(2, TokenType::Unknown);
+    next_.assign(2 * classCount_, kDead);
+    for (const auto& op : kOperators) {
+        uint16_t state = kStart;
+        for (unsigned char c : op.text) {
+            uint16_t& target = next_[state * classCount_ + classes_[c]];
+            if (target == kDead) {
+                target = static_cast<uint16_t>(accept_.size());
+                accept_.push_back(TokenType::Unknown);
+                next_.resize(next_.size() + classCount_, kDead);
+            }
+            state = next_[state * classCount_ + classes_[c]];
+        }
+        accept_[state] = op.type;
+    }
+}
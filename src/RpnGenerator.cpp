@@ -0,0 +1,392 @@
+// RpnGenerator.cpp
+#include "../include/RpnGenerator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
+namespace {
+
+namespace rpn = elangRPN;
+
+rpn::Token operand(rpn::Value value) {
+    return {rpn::TokenType::Operand, std::move(value)};
+}
+
+rpn::Token operation(rpn::OperatorType type) {
+    return {rpn::TokenType::Operator, type};
+}
+
+rpn::Token control(rpn::ControlFlowType type) {
+    return {rpn::TokenType::ControlFlow, type};
+}
+
+rpn::Token call(uint32_t argc) {
+    return {rpn::TokenType::Call, rpn::Arity{argc}};
+}
+
+// Заменяет чтения имён из scope в code на LoadLocal; во вложенных функциях
+// те же имена лежат на depth уровней дальше
+void resolveLocals(rpn::Expression& code, const std::unordered_map<SymbolId, uint32_t>& scope,
+                   uint32_t depth) {
+    for (rpn::Token& token : code.tokens) {
+        if (token.type == rpn::TokenType::Variable) {
+            auto it = scope.find(std::get<SymbolId>(token.value));
+            if (it != scope.end()) {
+                token = {rpn::TokenType::LoadLocal, rpn::Slot{it->second, depth, it->first}};
+            }
+        } else if (token.type == rpn::TokenType::Operand) {
+            const rpn::Value& value = std::get<rpn::Value>(token.value);
+            if (value.tag() == rpn::Value::Tag::Function) {
+                resolveLocals(*value.asFunction().expression, scope, depth + 1);
+            }
+        }
+    }
+}
+
+// Оставшиеся чтения имён - глобальные переменные
+void resolveGlobals(rpn::Expression& code) {
+    for (rpn::Token& token : code.tokens) {
+        if (token.type == rpn::TokenType::Variable) {
+            token = {rpn::TokenType::LoadGlobal, rpn::Slot{std::get<SymbolId>(token.value)}};
+        } else if (token.type == rpn::TokenType::Operand) {
+            const rpn::Value& value = std::get<rpn::Value>(token.value);
+            if (value.tag() == rpn::Value::Tag::Function) {
+                resolveGlobals(*value.asFunction().expression);
+            }
+        }
+    }
+}
+
+// Операция RPN для бинарного оператора; у -> и => её нет
+std::optional<rpn::OperatorType> binaryOperation(TokenType type) {
+    switch (type) {
+        case TokenType::OP_PLUS: return rpn::OperatorType::Add;
+        case TokenType::OP_MINUS: return rpn::OperatorType::Subtract;
+        case TokenType::OP_MULTIPLY: return rpn::OperatorType::Multiply;
+        case TokenType::OP_DIVIDE: return rpn::OperatorType::Divide;
+        case TokenType::OP_MODULO: return rpn::OperatorType::Modulo;
+        case TokenType::OP_EQUAL: return rpn::OperatorType::Equal;
+        case TokenType::OP_NOT_EQUAL: return rpn::OperatorType::NotEqual;
+        case TokenType::OP_LESS: return rpn::OperatorType::LessThan;
+        case TokenType::OP_GREATER: return rpn::OperatorType::GreaterThan;
+        case TokenType::OP_LESS_EQUAL: return rpn::OperatorType::LessEqual;
+        case TokenType::OP_GREATER_EQUAL: return rpn::OperatorType::GreaterEqual;
+        case TokenType::OP_AND: return rpn::OperatorType::LogicalAnd;
+        case TokenType::OP_OR: return rpn::OperatorType::LogicalOr;
+        default: return std::nullopt;
+    }
+}
+
+}  // namespace
+
+RpnGenerator::RpnGenerator(Lexer& lexer) : stream_(lexer), source_(lexer.sourceBuffer()) {}
+
+RpnGenerator::RpnGenerator(const std::vector<Token>& tokens, std::shared_ptr<const SourceBuffer> source)
+    : stream_(std::span<const Token>(tokens)), source_(std::move(source)) {}
+
+std::shared_ptr<elangRPN::Expression> RpnGenerator::generate() {
+    auto program = std::make_shared<rpn::Expression>();
+    parseStatements(program->tokens);
+    if (current().type != TokenType::EndOfFile) {
+        fail("Unexpected token: " + std::string(current().value));  // лишняя "}"
+    }
+    program->link();
+    resolveGlobals(*program);
+    return program;
+}
+
+// Ошибка в позиции текущего токена
+void RpnGenerator::fail(const std::string& message) {
+    Diagnostic diagnostic{current().offset, 0, 0, message};
+    if (source_) {
+        SourcePosition pos = source_->position(diagnostic.offset);
+        diagnostic.line = pos.line;
+        diagnostic.column = pos.column;
+    }
+    throw SyntaxError(diagnostic);
+}
+
+void RpnGenerator::expect(TokenType type, const char* spelling) {
+    if (current().type != type) {
+        fail(std::string("Expected ") + spelling + ", but got: " + std::string(current().value));
+    }
+    advance();
+}
+
+void RpnGenerator::emitStore(Code& out, std::string_view name) {
+    SymbolId id = rpn::symbol(name);
+    if (scopes_.empty()) {
+        out.push_back({rpn::TokenType::StoreGlobal, rpn::Slot{id}});
+        return;
+    }
+    auto& slots = scopes_.back().slots;
+    auto [it, added] = slots.emplace(id, static_cast<uint32_t>(slots.size()));
+    out.push_back({rpn::TokenType::StoreLocal, rpn::Slot{it->second}});
+}
+
+// Операторы до "}" или конца файла
+void RpnGenerator::parseStatements(Code& out) {
+    while (current().type != TokenType::RBRACE && current().type != TokenType::EndOfFile) {
+        parseStatement(out);
+    }
+}
+
+void RpnGenerator::parseBlock(Code& out) {
+    expect(TokenType::LBRACE, "{");
+    parseStatements(out);
+    expect(TokenType::RBRACE, "}");
+}
+
+void RpnGenerator::parseStatement(Code& out) {
+    switch (current().type) {
+        case TokenType::KW_FUNCTION:
+            parseFunctionDeclaration(out);
+            return;
+        case TokenType::KW_LET:
+        case TokenType::KW_VAR:
+            parseVariableDeclaration(out);
+            return;
+        case TokenType::KW_IF:
+            parseIf(out);
+            return;
+        case TokenType::KW_WHILE:
+            parseWhile(out);
+            return;
+        case TokenType::KW_RETURN:
+            parseReturn(out);
+            return;
+        case TokenType::Identifier:
+            // Присваивание
+            if (stream_.peek(1).type == TokenType::OP_ASSIGN) {
+                std::string_view name = current().value;
+                advance();
+                advance();
+                parseExpression(out);
+                emitStore(out, name);
+                expect(TokenType::SEMICOLON, ";");
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    // Значение выражения-оператора не нужно
+    parseExpression(out);
+    out.push_back(operation(rpn::OperatorType::Pop));
+    expect(TokenType::SEMICOLON, ";");
+}
+
+// Тело функции - отдельная программа; функция присваивается своему имени
+void RpnGenerator::parseFunctionDeclaration(Code& out) {
+    advance();  // Пропускаем "function"
+    std::string_view name = current().value;
+    expect(TokenType::Identifier, "function name");
+    expect(TokenType::LPAREN, "(");
+    auto body = std::make_shared<rpn::Expression>();
+    const rpn::Expression* enclosing = scopes_.empty() ? nullptr : scopes_.back().body;
+    scopes_.push_back({body.get(), {}});
+    std::vector<SymbolId> parameters;
+    while (current().type != TokenType::RPAREN) {
+        SymbolId parameter = rpn::symbol(current().value);
+        parameters.push_back(parameter);
+        // Повторный параметр занимает ту же ячейку; аргумент для неё - последний
+        scopes_.back().slots.emplace(parameter, static_cast<uint32_t>(parameters.size() - 1));
+        expect(TokenType::Identifier, "parameter name");
+        if (current().type == TokenType::COLON) {
+            advance();
+            expect(TokenType::Identifier, "type");
+        }
+        if (current().type != TokenType::COMMA) {
+            break;
+        }
+        advance();
+    }
+    expect(TokenType::RPAREN, ")");
+    if (current().type == TokenType::COLON) {
+        advance();
+        expect(TokenType::Identifier, "type");
+    }
+
+    parseBlock(body->tokens);
+    body->link();
+
+    Scope scope = std::move(scopes_.back());
+    scopes_.pop_back();
+    resolveLocals(*body, scope.slots, 0);
+    rpn::ElgPrimitive::Function function(rpn::symbol(name), std::move(parameters), body);
+    function.resolved = true;
+    function.slots = static_cast<uint32_t>(std::max(scope.slots.size(), function.parameters.size()));
+    function.enclosing = enclosing;
+    body->slotNames.assign(function.slots, kNoSymbol);
+    for (const auto& [id, index] : scope.slots) {
+        body->slotNames[index] = id;
+    }
+    out.push_back(operand(rpn::Value(std::move(function))));
+    emitStore(out, name);
+}
+
+void RpnGenerator::parseVariableDeclaration(Code& out) {
+    advance();  // Пропускаем "let" или "var"
+    std::string_view name = current().value;
+    expect(TokenType::Identifier, "variable name");
+    expect(TokenType::OP_ASSIGN, "=");
+    parseExpression(out);
+    emitStore(out, name);
+    if (current().type == TokenType::SEMICOLON) {
+        advance();
+    }
+}
+
+// elif и else if - вложенный If в ветке Else
+void RpnGenerator::parseIf(Code& out) {
+    advance();  // Пропускаем "if" или "elif"
+    parseExpression(out);
+    out.push_back(control(rpn::ControlFlowType::If));
+    parseBlock(out);
+    if (current().type == TokenType::KW_ELIF) {
+        out.push_back(control(rpn::ControlFlowType::Else));
+        parseIf(out);
+    } else if (current().type == TokenType::KW_ELSE) {
+        out.push_back(control(rpn::ControlFlowType::Else));
+        advance();
+        if (current().type == TokenType::KW_IF) {
+            parseIf(out);
+        } else {
+            parseBlock(out);
+        }
+    }
+    out.push_back(control(rpn::ControlFlowType::EndIf));
+}
+
+// While/EndWhile интерпретатора - цикл с проверкой в конце, поэтому условие
+// проверяется ещё и перед первым проходом: код условия выдаётся дважды
+void RpnGenerator::parseWhile(Code& out) {
+    advance();  // Пропускаем "while"
+    size_t conditionStart = out.size();
+    parseExpression(out);
+    Code condition(out.begin() + conditionStart, out.end());
+    out.push_back(control(rpn::ControlFlowType::If));
+    out.push_back(control(rpn::ControlFlowType::While));
+    parseBlock(out);
+    std::copy(condition.begin(), condition.end(), std::back_inserter(out));
+    out.push_back(control(rpn::ControlFlowType::EndWhile));
+    out.push_back(control(rpn::ControlFlowType::EndIf));
+}
+
+void RpnGenerator::parseReturn(Code& out) {
+    advance();  // Пропускаем "return"
+    if (current().type == TokenType::SEMICOLON) {
+        out.push_back(operand(rpn::Value()));
+    } else {
+        parseExpression(out);
+    }
+    out.push_back(control(rpn::ControlFlowType::Return));
+    expect(TokenType::SEMICOLON, ";");
+}
+
+// Выражение (Пратт, как в SyntaxAnalyzer::parseExpression), но вместо узла
+// дерева оператор сразу выдаётся в out за своими операндами. Левая часть
+// занимает out[start, конец): её начало нужно вызову.
+void RpnGenerator::parseExpression(Code& out, uint8_t minPrecedence) {
+    const size_t start = out.size();
+    parsePrefix(out);
+    for (;;) {
+        const SyntaxAnalyzer::OperatorRule& rule = SyntaxAnalyzer::operatorRule(current().type);
+        if (rule.infix <= minPrecedence) {
+            return;
+        }
+        Token op = current();
+        switch (rule.form) {
+            case SyntaxAnalyzer::InfixForm::Call:
+                advance();
+                parseCall(out, start);
+                break;
+            case SyntaxAnalyzer::InfixForm::Member:
+                advance();
+                out.push_back(operand(rpn::Value(std::string(current().value))));
+                expect(TokenType::Identifier, "property name");
+                out.push_back(operation(rpn::OperatorType::AccessProperty));
+                break;
+            case SyntaxAnalyzer::InfixForm::Binary: {
+                std::optional<rpn::OperatorType> type = binaryOperation(op.type);
+                if (!type) {
+                    fail("Operator " + std::string(op.value) + " is not supported in RPN");
+                }
+                advance();
+                parseExpression(out, rule.rightAssoc ? rule.infix - 1 : rule.infix);
+                out.push_back(operation(*type));
+                break;
+            }
+        }
+    }
+}
+
+void RpnGenerator::parsePrefix(Code& out) {
+    uint8_t precedence = SyntaxAnalyzer::operatorRule(current().type).prefix;
+    if (precedence == 0) {
+        parsePrimary(out);
+        return;
+    }
+    rpn::OperatorType type =
+        current().type == TokenType::OP_MINUS ? rpn::OperatorType::Negate : rpn::OperatorType::LogicalNot;
+    advance();
+    parseExpression(out, precedence);
+    out.push_back(operation(type));
+}
+
+// Аргументы вызова; "(" уже пропущена. Код вызываемого выражения
+// out[calleeStart, конец) переносится за аргументы.
+void RpnGenerator::parseCall(Code& out, size_t calleeStart) {
+    Code callee(std::make_move_iterator(out.begin() + calleeStart), std::make_move_iterator(out.end()));
+    out.erase(out.begin() + calleeStart, out.end());
+    uint32_t argc = 0;
+    if (current().type != TokenType::RPAREN) {
+        for (;;) {
+            parseExpression(out);
+            ++argc;
+            if (current().type != TokenType::COMMA) {
+                break;
+            }
+            advance();
+        }
+    }
+    expect(TokenType::RPAREN, ")");
+    std::move(callee.begin(), callee.end(), std::back_inserter(out));
+    out.push_back(call(argc));
+}
+
+void RpnGenerator::parsePrimary(Code& out) {
+    const Token& tok = current();
+    switch (tok.type) {
+        case TokenType::IntegerLiteral:
+            out.push_back(operand(rpn::Value(tok.intValue)));
+            break;
+        case TokenType::FloatLiteral:
+            out.push_back(operand(rpn::Value(tok.floatValue)));
+            break;
+        case TokenType::StringLiteral:
+            out.push_back(operand(rpn::Value(std::string(tok.value))));
+            break;
+        case TokenType::BooleanLiteral:
+            out.push_back(operand(rpn::Value(int64_t{tok.boolValue})));
+            break;
+        case TokenType::KW_NULL:
+            out.push_back(operand(rpn::Value::null()));
+            break;
+        case TokenType::KW_UNDEFINED:
+            out.push_back(operand(rpn::Value()));
+            break;
+        case TokenType::Identifier:
+            out.push_back({rpn::TokenType::Variable, rpn::symbol(tok.value)});
+            break;
+        case TokenType::LPAREN:
+            advance();
+            parseExpression(out);
+            expect(TokenType::RPAREN, ")");
+            return;
+        default:
+            fail("Unexpected token in expression: " + std::string(tok.value));
+    }
+    advance();
+}
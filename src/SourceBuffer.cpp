@@ -0,0 +1,94 @@
+// SourceBuffer.cpp
+#include "../include/SourceBuffer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "../include/CharScan.h"
+
+// Создаёт буфер, владеющий копией текста
+std::shared_ptr<const SourceBuffer> SourceBuffer::fromString(std::string text) {
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->owned_ = std::move(text);
+    buffer->data_ = buffer->owned_.data();
+    buffer->size_ = buffer->owned_.size();
+    return buffer;
+}
+
+// Отображает файл в память только для чтения
+std::shared_ptr<const SourceBuffer> SourceBuffer::mapFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(err));
+    }
+
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    // Пустой файл нельзя отобразить, он просто даёт пустой буфер
+    if (st.st_size > 0) {
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("Cannot mmap " + path + ": " + std::strerror(err));
+        }
+        // Лексер читает файл строго последовательно
+        ::madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        buffer->data_ = static_cast<const char*>(addr);
+        buffer->size_ = static_cast<size_t>(st.st_size);
+        buffer->mapped_ = true;
+    }
+    ::close(fd);
+    return buffer;
+}
+
+SourceBuffer::~SourceBuffer() {
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+// Индекс начал строк за один векторный проход по тексту
+const std::vector<uint32_t>& SourceBuffer::lineStarts() const {
+    std::call_once(lineStartsOnce_, [this] {
+        // Переводы строк выписываются блоками, чтобы не заводить буфер
+        // размером с весь текст
+        constexpr size_t kBlock = 4096;
+        uint32_t found[kBlock];
+        lineStarts_.assign(1, 0);
+        for (size_t from = 0; from < size_; from += kBlock) {
+            size_t to = std::min(from + kBlock, size_);
+            size_t count = charscan::findNewlines(data_ + from, data_ + to, found);
+            for (size_t i = 0; i < count; ++i) {
+                lineStarts_.push_back(static_cast<uint32_t>(from + found[i] + 1));
+            }
+        }
+    });
+    return lineStarts_;
+}
+
+SourcePosition SourceBuffer::position(size_t offset) const {
+    offset = std::min(offset, size_);
+    const std::vector<uint32_t>& starts = lineStarts();
+    // Последнее начало строки, не превосходящее offset
+    auto it = std::upper_bound(starts.begin(), starts.end(), offset) - 1;
+    // Продолжающие байты UTF-8 (10xxxxxx) не начинают новый символ
+    int column = 1;
+    for (size_t i = *it; i < offset; ++i) {
+        column += (static_cast<unsigned char>(data_[i]) & 0xC0) != 0x80;
+    }
+    return {static_cast<int>(it - starts.begin()) + 1, column};
+}
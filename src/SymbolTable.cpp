@@ -0,0 +1,36 @@
+// SymbolTable.cpp
+#include "../include/SymbolTable.h"
+
+SymbolTable& SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+// Возвращает номер имени, добавляя его при первой встрече
+SymbolId SymbolTable::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    SymbolId id = static_cast<SymbolId>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+std::string_view SymbolTable::name(SymbolId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return id < names_.size() ? std::string_view(names_[id]) : std::string_view();
+}
+
+size_t SymbolTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
+
+void SymbolTable::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ids_.clear();
+    names_.clear();
+}
@@ -1,29 +1,136 @@
 #include "../include/Syntaxer.h"
 
+#include <array>
+
+namespace {
+
+// Уровни связывания операторов: чем больше, тем сильнее.
+// 0 - токен не является оператором в этой позиции.
+enum Precedence : uint8_t {
+    kNone = 0,
+    kMatchArm,        // =>
+    kArrow,           // ->
+    kOr,              // ||
+    kAnd,             // &&
+    kEquality,        // == !=
+    kRelational,      // < > <= >=
+    kAdditive,        // + -
+    kMultiplicative,  // * / %
+    kPrefix,          // ! -
+    kPostfix,         // . и вызов
+};
+
+constexpr size_t kTokenTypeCount = static_cast<size_t>(TokenType::DOT) + 1;
+
+// Правила всех операторов выражений; новый оператор - одна строка здесь
+constexpr std::array<SyntaxAnalyzer::OperatorRule, kTokenTypeCount> buildOperatorRules() {
+    using Form = SyntaxAnalyzer::InfixForm;
+    std::array<SyntaxAnalyzer::OperatorRule, kTokenTypeCount> rules{};
+    auto infix = [&](TokenType type, Precedence precedence, Form form = Form::Binary, bool rightAssoc = false) {
+        auto& rule = rules[static_cast<size_t>(type)];
+        rule.infix = precedence;
+        rule.form = form;
+        rule.rightAssoc = rightAssoc;
+    };
+    auto prefix = [&](TokenType type, Precedence precedence) {
+        rules[static_cast<size_t>(type)].prefix = precedence;
+    };
+    infix(TokenType::OP_DOUBLE_ARROW, kMatchArm, Form::Binary, true);
+    infix(TokenType::OP_ARROW, kArrow, Form::Binary, true);
+    infix(TokenType::OP_OR, kOr);
+    infix(TokenType::OP_AND, kAnd);
+    infix(TokenType::OP_EQUAL, kEquality);
+    infix(TokenType::OP_NOT_EQUAL, kEquality);
+    infix(TokenType::OP_LESS, kRelational);
+    infix(TokenType::OP_GREATER, kRelational);
+    infix(TokenType::OP_LESS_EQUAL, kRelational);
+    infix(TokenType::OP_GREATER_EQUAL, kRelational);
+    infix(TokenType::OP_PLUS, kAdditive);
+    infix(TokenType::OP_MINUS, kAdditive);
+    infix(TokenType::OP_MULTIPLY, kMultiplicative);
+    infix(TokenType::OP_DIVIDE, kMultiplicative);
+    infix(TokenType::OP_MODULO, kMultiplicative);
+    infix(TokenType::DOT, kPostfix, Form::Member);
+    infix(TokenType::LPAREN, kPostfix, Form::Call);
+    prefix(TokenType::OP_NOT, kPrefix);
+    prefix(TokenType::OP_MINUS, kPrefix);
+    return rules;
+}
+
+constexpr std::array<SyntaxAnalyzer::OperatorRule, kTokenTypeCount> kOperatorRules = buildOperatorRules();
+
+}  // namespace
+
+const SyntaxAnalyzer::OperatorRule& SyntaxAnalyzer::operatorRule(TokenType type) {
+    return kOperatorRules[static_cast<size_t>(type)];
+}
+
 // Возвращает текущий токен
-Token& SyntaxAnalyzer::current() {
-    if (currentIndex_ >= tokens_.size()) {
-        static Token eof(TokenType::EndOfFile, "", -1, -1);
-        return eof;
+const Token& SyntaxAnalyzer::current() {
+    return stream_.peek();
+}
+
+// Записывает ошибку в позиции текущего токена и возвращает kNoNode, чтобы
+// вызывающий мог сразу вернуть его выше. Строка и столбец вычисляются только
+// здесь, когда ошибка уже случилась. Без восстановления хранится только первая
+// ошибка: разбор после неё сворачивается без новых записей.
+NodeId SyntaxAnalyzer::fail(const std::string& message) {
+    if (!recover_ && !diagnostics_.empty()) {
+        return kNoNode;
     }
-    return tokens_[currentIndex_];
+    Diagnostic diagnostic{current().offset, 0, 0, message};
+    if (source_) {
+        SourcePosition pos = source_->position(diagnostic.offset);
+        diagnostic.line = pos.line;
+        diagnostic.column = pos.column;
+    }
+    diagnostics_.push_back(std::move(diagnostic));
+    return kNoNode;
 }
 
 // Переходит к следующему токену
 void SyntaxAnalyzer::advance() {
-    if (currentIndex_ < tokens_.size()) {
-        ++currentIndex_;
-    }
+    stream_.advance();
 }
 
 // Проверяет ожидаемый токен и продвигается вперед
-void SyntaxAnalyzer::expect(TokenType type) {
+bool SyntaxAnalyzer::expect(TokenType type) {
     if (current().type != type) {
-        throw SyntaxError("Expected token of type " + tokenTypeToString(type) +
-                          ", but got " + tokenTypeToString(current().type),
-                          current().line, current().column);
+        fail("Expected token of type " + tokenTypeToString(type) +
+             ", but got " + tokenTypeToString(current().type));
+        return false;
     }
     advance();
+    return true;
+}
+
+// Пропускает токены до точки синхронизации: за ";", перед "}" или перед
+// словом, с которого начинается объявление. start - смещение первого токена
+// ошибочного оператора: если разбор не сдвинулся с него, токен пропускается,
+// иначе следующая попытка споткнётся о него же.
+void SyntaxAnalyzer::synchronize(uint32_t start) {
+    if (current().offset == start && current().type != TokenType::SEMICOLON) {
+        advance();
+    }
+    for (;;) {
+        switch (current().type) {
+            case TokenType::SEMICOLON:
+                advance();
+                return;
+            case TokenType::EndOfFile:
+            case TokenType::RBRACE:
+            case TokenType::KW_FUNCTION:
+            case TokenType::KW_LET:
+            case TokenType::KW_VAR:
+            case TokenType::KW_GET:
+            case TokenType::KW_POST:
+            case TokenType::KW_PUT:
+            case TokenType::KW_DELETE:
+                return;
+            default:
+                advance();
+        }
+    }
 }
 
 // Преобразует TokenType в строку
@@ -42,175 +149,312 @@ std::string SyntaxAnalyzer::tokenTypeToString(TokenType type) {
         case TokenType::SEMICOLON: return ";";
         case TokenType::OP_ASSIGN: return "=";
         case TokenType::IntegerLiteral: return "integer literal";
+        case TokenType::FloatLiteral: return "float literal";
         default: return "unknown";
     }
 }
 
+// Лист дерева по токену: имя, литерал или оператор
+NodeId SyntaxAnalyzer::leaf(NodeKind kind, const Token& tok) {
+    NodeId id = ast_.add(kind, tok.offset, tok.type);
+    AstNode& node = ast_[id];
+    node.text = tok.value;
+    node.symbol = tok.symbol;
+    node.intValue = tok.intValue;
+    if (tok.type == TokenType::BooleanLiteral) {
+        node.boolValue = tok.boolValue;
+    }
+    return id;
+}
+
+// Узел бинарной операции op с операндами left и right
+NodeId SyntaxAnalyzer::binary(const Token& op, NodeId left, NodeId right) {
+    if (right == kNoNode) {
+        return kNoNode;
+    }
+    NodeId id = leaf(NodeKind::Binary, op);
+    ast_[id].firstChild = left;
+    ast_[left].nextSibling = right;
+    return id;
+}
+
 // Анализ программы
-void SyntaxAnalyzer::parseProgram() {
-    while (current().type != TokenType::EndOfFile) {
-        parseStatement();
+NodeId SyntaxAnalyzer::parseProgram() {
+    NodeId program = ast_.add(NodeKind::Program, current().offset);
+    ChildList statements(ast_, program);
+    for (;;) {
+        if (!parseStatements(statements)) {
+            return kNoNode;
+        }
+        if (current().type == TokenType::EndOfFile || atLimit()) {
+            return program;
+        }
+        // Лишняя "}" на верхнем уровне
+        fail("Unexpected token: " + std::string(current().value));
+        if (!recover_) {
+            return kNoNode;
+        }
+        advance();
+    }
+}
+
+// Анализ последовательности операторов до "}" или конца файла.
+// При восстановлении ошибочный оператор пропускается до точки синхронизации;
+// без него первая ошибка прерывает разбор (false).
+bool SyntaxAnalyzer::parseStatements(ChildList& statements) {
+    while (current().type != TokenType::RBRACE && current().type != TokenType::EndOfFile && !atLimit()) {
+        uint32_t start = current().offset;
+        NodeId statement = parseStatement();
+        if (statement != kNoNode) {
+            statements.append(statement);
+            continue;
+        }
+        if (!recover_) {
+            return false;
+        }
+        synchronize(start);
     }
+    return true;
 }
 
 // Анализ операторов
-void SyntaxAnalyzer::parseStatement() {
+NodeId SyntaxAnalyzer::parseStatement() {
     if (current().type == TokenType::KW_FUNCTION) {
-        parseFunctionDeclaration();
+        return parseFunctionDeclaration();
     } else if (current().type == TokenType::KW_VAR || current().type == TokenType::KW_LET) {
-        parseVariableDeclaration();
+        return parseVariableDeclaration();
     } else if (current().type == TokenType::Identifier) {
-        parseExpressionStatement();
+        return parseExpressionStatement();
     } else {
-        throw SyntaxError("Unexpected token: " + current().value, current().line, current().column);
+        return fail("Unexpected token: " + std::string(current().value));
     }
 }
 
 // Анализ объявления функции
-void SyntaxAnalyzer::parseFunctionDeclaration() {
-    expect(TokenType::KW_FUNCTION);
-    expect(TokenType::Identifier); // Имя функции
-    expect(TokenType::LPAREN);
-    if (current().type != TokenType::RPAREN) {
-        parseParameters();
+NodeId SyntaxAnalyzer::parseFunctionDeclaration() {
+    uint32_t offset = current().offset;
+    advance(); // Пропускаем "function"
+    NodeId function = leaf(NodeKind::FunctionDecl, current());
+    ast_[function].offset = offset;
+    if (!expect(TokenType::Identifier)) { // Имя функции
+        return kNoNode;
+    }
+    ChildList children(ast_, function);
+    if (!expect(TokenType::LPAREN)) {
+        return kNoNode;
+    }
+    if (current().type != TokenType::RPAREN && !parseParameters(children)) {
+        return kNoNode;
+    }
+    if (!expect(TokenType::RPAREN)) {
+        return kNoNode;
     }
-    expect(TokenType::RPAREN);
     if (current().type == TokenType::COLON) {
         advance(); // Пропускаем ":"
-        parseType();
+        NodeId type = parseType();
+        if (type == kNoNode) {
+            return kNoNode;
+        }
+        children.append(type);
     }
-    expect(TokenType::LBRACE);
-    while (current().type != TokenType::RBRACE) {
-        parseStatement();
+    NodeId body = ast_.add(NodeKind::Block, current().offset);
+    children.append(body);
+    ChildList statements(ast_, body);
+    if (!expect(TokenType::LBRACE) || !parseStatements(statements) || !expect(TokenType::RBRACE)) {
+        return kNoNode;
     }
-    expect(TokenType::RBRACE);
+    return function;
 }
 
 // Анализ параметров функции
-void SyntaxAnalyzer::parseParameters() {
+bool SyntaxAnalyzer::parseParameters(ChildList& parameters) {
     do {
-        expect(TokenType::Identifier); // Имя параметра
-        expect(TokenType::COLON);
-        parseType();
+        NodeId parameter = leaf(NodeKind::Parameter, current());
+        if (!expect(TokenType::Identifier) || !expect(TokenType::COLON)) { // Имя параметра и ":"
+            return false;
+        }
+        NodeId type = parseType();
+        if (type == kNoNode) {
+            return false;
+        }
+        ast_[parameter].firstChild = type;
+        parameters.append(parameter);
         if (current().type == TokenType::COMMA) {
             advance();
         }
     } while (current().type != TokenType::RPAREN);
+    return true;
 }
 
 // Анализ объявления переменной
-void SyntaxAnalyzer::parseVariableDeclaration() {
+NodeId SyntaxAnalyzer::parseVariableDeclaration() {
+    uint32_t offset = current().offset;
+    TokenType keyword = current().type;
     advance(); // Пропускаем "var" или "let"
-    expect(TokenType::Identifier); // Имя переменной
-    expect(TokenType::OP_ASSIGN);
-    parseExpression();
-}
-
-// Анализ типа
-void SyntaxAnalyzer::parseType() {
-    if (current().type == TokenType::Identifier) {
-        advance();
-    } else {
-        throw SyntaxError("Expected a type, but got: " + current().value, current().line, current().column);
+    NodeId variable = leaf(NodeKind::VariableDecl, current());
+    ast_[variable].offset = offset;
+    ast_[variable].op = keyword;
+    if (!expect(TokenType::Identifier) || !expect(TokenType::OP_ASSIGN)) { // Имя переменной и "="
+        return kNoNode;
     }
-}
-
-// Анализ выражения в строке
-void SyntaxAnalyzer::parseExpressionStatement() {
-    parseExpression();
-    expect(TokenType::SEMICOLON);
-}
-
-// Анализ выражения
-void SyntaxAnalyzer::parseExpression() {
-    parseLogicalOr();
-}
-
-// Анализ логического "или"
-void SyntaxAnalyzer::parseLogicalOr() {
-    parseLogicalAnd();
-    while (current().type == TokenType::OP_OR) {
-        advance();
-        parseLogicalAnd();
+    NodeId initializer = parseExpression();
+    if (initializer == kNoNode) {
+        return kNoNode;
     }
+    ast_[variable].firstChild = initializer;
+    return variable;
 }
 
-// Анализ логического "и"
-void SyntaxAnalyzer::parseLogicalAnd() {
-    parseEquality();
-    while (current().type == TokenType::OP_AND) {
-        advance();
-        parseEquality();
+// Анализ типа
+NodeId SyntaxAnalyzer::parseType() {
+    if (current().type != TokenType::Identifier) {
+        return fail("Expected a type, but got: " + std::string(current().value));
     }
+    NodeId type = leaf(NodeKind::Type, current());
+    advance();
+    return type;
 }
 
-// Анализ операций сравнения
-void SyntaxAnalyzer::parseEquality() {
-    parseRelational();
-    while (current().type == TokenType::OP_EQUAL || current().type == TokenType::OP_NOT_EQUAL) {
-        advance();
-        parseRelational();
+// Анализ выражения в строке
+NodeId SyntaxAnalyzer::parseExpressionStatement() {
+    NodeId statement = ast_.add(NodeKind::ExpressionStatement, current().offset);
+    NodeId expression = parseExpression();
+    if (expression == kNoNode || !expect(TokenType::SEMICOLON)) {
+        return kNoNode;
     }
+    ast_[statement].firstChild = expression;
+    return statement;
 }
 
-// Анализ операций отношения
-void SyntaxAnalyzer::parseRelational() {
-    parseAdditive();
-    while (current().type == TokenType::OP_LESS || current().type == TokenType::OP_GREATER ||
-           current().type == TokenType::OP_LESS_EQUAL || current().type == TokenType::OP_GREATER_EQUAL) {
+// Анализ выражения (Пратт): сначала префиксная часть, затем, пока следующий
+// оператор связывает сильнее minPrecedence, он присоединяет уже разобранную
+// левую часть
+NodeId SyntaxAnalyzer::parseExpression(uint8_t minPrecedence) {
+    NodeId left = parsePrefix();
+    while (left != kNoNode) {
+        const OperatorRule& rule = operatorRule(current().type);
+        if (rule.infix <= minPrecedence) {
+            return left;
+        }
+        Token op = current();
         advance();
-        parseAdditive();
+        switch (rule.form) {
+            case InfixForm::Call:
+                left = parseCall(op, left);
+                break;
+            case InfixForm::Member: {
+                NodeId member = leaf(NodeKind::Identifier, current());
+                left = expect(TokenType::Identifier) ? binary(op, left, member) : kNoNode; // Имя свойства
+                break;
+            }
+            case InfixForm::Binary:
+                // Правоассоциативный оператор отдаёт правой части свой уровень
+                left = binary(op, left, parseExpression(rule.rightAssoc ? rule.infix - 1 : rule.infix));
+                break;
+        }
     }
+    return kNoNode;
 }
 
-// Анализ сложения/вычитания
-void SyntaxAnalyzer::parseAdditive() {
-    parseMultiplicative();
-    while (current().type == TokenType::OP_PLUS || current().type == TokenType::OP_MINUS) {
-        advance();
-        parseMultiplicative();
+// Анализ префиксной части: цепочка унарных операций и первичное выражение
+NodeId SyntaxAnalyzer::parsePrefix() {
+    uint8_t precedence = operatorRule(current().type).prefix;
+    if (precedence == 0) {
+        return parsePrimary();
     }
-}
-
-// Анализ умножения/деления/остатка
-void SyntaxAnalyzer::parseMultiplicative() {
-    parseUnary();
-    while (current().type == TokenType::OP_MULTIPLY || current().type == TokenType::OP_DIVIDE || current().type == TokenType::OP_MODULO) {
-        advance();
-        parseUnary();
+    NodeId unary = leaf(NodeKind::Unary, current());
+    advance();
+    NodeId operand = parseExpression(precedence);
+    if (operand == kNoNode) {
+        return kNoNode;
     }
+    ast_[unary].firstChild = operand;
+    return unary;
 }
 
-// Анализ унарных операций
-void SyntaxAnalyzer::parseUnary() {
-    if (current().type == TokenType::OP_NOT || current().type == TokenType::OP_MINUS) {
-        advance();
+// Анализ аргументов вызова; "(" уже пропущена
+NodeId SyntaxAnalyzer::parseCall(const Token& paren, NodeId callee) {
+    NodeId call = ast_.add(NodeKind::Call, paren.offset, paren.type);
+    ChildList children(ast_, call);
+    children.append(callee);
+    if (current().type != TokenType::RPAREN) {
+        for (;;) {
+            NodeId argument = parseExpression();
+            if (argument == kNoNode) {
+                return kNoNode;
+            }
+            children.append(argument);
+            if (current().type != TokenType::COMMA) {
+                break;
+            }
+            advance();
+        }
     }
-    parsePrimary();
+    return expect(TokenType::RPAREN) ? call : kNoNode;
 }
 
 // Анализ первичных выражений
-void SyntaxAnalyzer::parsePrimary() {
-    if (current().type == TokenType::IntegerLiteral || current().type == TokenType::StringLiteral ||
-        current().type == TokenType::BooleanLiteral || current().type == TokenType::Identifier) {
-        advance();
-    } else if (current().type == TokenType::LPAREN) {
-        advance();
-        parseExpression();
-        expect(TokenType::RPAREN);
-    } else {
-        throw SyntaxError("Unexpected token in expression: " + current().value, current().line, current().column);
+NodeId SyntaxAnalyzer::parsePrimary() {
+    switch (current().type) {
+        case TokenType::IntegerLiteral:
+        case TokenType::FloatLiteral:
+        case TokenType::StringLiteral:
+        case TokenType::BooleanLiteral: {
+            NodeId literal = leaf(NodeKind::Literal, current());
+            advance();
+            return literal;
+        }
+        case TokenType::Identifier: {
+            NodeId identifier = leaf(NodeKind::Identifier, current());
+            advance();
+            return identifier;
+        }
+        case TokenType::LPAREN: {
+            advance();
+            NodeId inner = parseExpression();
+            return inner != kNoNode && expect(TokenType::RPAREN) ? inner : kNoNode;
+        }
+        default:
+            return fail("Unexpected token in expression: " + std::string(current().value));
     }
 }
 
 // Конструктор
-SyntaxAnalyzer::SyntaxAnalyzer(const std::vector<Token>& tokens) : tokens_(tokens) {}
+SyntaxAnalyzer::SyntaxAnalyzer(const std::vector<Token>& tokens, std::shared_ptr<const SourceBuffer> source)
+    : stream_(std::span<const Token>(tokens)), source_(std::move(source)) {}
+
+SyntaxAnalyzer::SyntaxAnalyzer(Lexer& lexer) : stream_(lexer), source_(lexer.sourceBuffer()) {}
+
+SyntaxAnalyzer::SyntaxAnalyzer(const TokenBuffer& buffer) : stream_(buffer), source_(buffer.source()) {}
+
+SyntaxAnalyzer::SyntaxAnalyzer(const TokenStream& stream, std::shared_ptr<const SourceBuffer> source)
+    : stream_(stream), source_(std::move(source)) {}
+
+// Разбор с восстановлением или до первой ошибки; результат - в ast_ и
+// diagnostics_
+void SyntaxAnalyzer::run(bool recover) {
+    recover_ = recover;
+    diagnostics_.clear();
+    ast_.clear();
+    ast_.setRoot(parseProgram());
+}
 
 // Запуск анализа
 void SyntaxAnalyzer::analyze() {
-    parseProgram();
-    if (current().type != TokenType::EndOfFile) {
-        throw SyntaxError("Unexpected tokens at the end of the file.", current().line, current().column);
+    run(false);
+    if (!diagnostics_.empty()) {
+        throw SyntaxError(diagnostics_.front());
     }
-    std::cout << "Parsing completed successfully.\n";
+}
+
+bool SyntaxAnalyzer::analyzeAll() {
+    run(true);
+    return diagnostics_.empty();
+}
+
+bool SyntaxAnalyzer::analyzeAllUntil(size_t end) {
+    limit_ = end;
+    run(true);
+    limit_ = SIZE_MAX;
+    return diagnostics_.empty();
 }
@@ -0,0 +1,139 @@
+// SyntaxerParallel.cpp
+// Параллельный синтаксический анализ: предварительный проход по видам токенов
+// находит границы объявлений верхнего уровня, затем группы объявлений
+// разбираются независимо, каждая в своё дерево.
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+#include "../include/Syntaxer.h"
+
+namespace {
+
+// Меньшие группы не окупают отдельного дерева и задания пула
+constexpr size_t kMinGroupTokens = 16 * 1024;
+
+// Номера токенов, с которых начинаются объявления вне фигурных скобок.
+// Глубина по скобкам не меньше глубины вложенности, которую видит разбор
+// (он открывает блок только на "{", а закрывает на любой "}"), поэтому на
+// такой границе последовательный разбор всегда начинает новый оператор
+// верхнего уровня: ни оператор, ни пропуск после ошибки не переходят через
+// ключевое слово объявления.
+std::vector<size_t> declarationStarts(const TokenStream& stream) {
+    std::vector<size_t> starts;
+    size_t depth = 0;
+    for (size_t i = 0, n = stream.size(); i < n; ++i) {
+        TokenType type = stream.type(i);
+        if (type == TokenType::LBRACE) {
+            ++depth;
+        } else if (type == TokenType::RBRACE) {
+            depth -= depth > 0;
+        } else if (depth == 0 && SyntaxAnalyzer::startsDeclaration(type)) {
+            starts.push_back(i);
+        }
+    }
+    return starts;
+}
+
+}  // namespace
+
+bool SyntaxAnalyzer::startsDeclaration(TokenType type) {
+    switch (type) {
+        case TokenType::KW_FUNCTION:
+        case TokenType::KW_LET:
+        case TokenType::KW_VAR:
+        case TokenType::KW_GET:
+        case TokenType::KW_POST:
+        case TokenType::KW_PUT:
+        case TokenType::KW_DELETE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Токены делятся на группы примерно поровну по границам объявлений, группы
+// разбираются параллельно, и их деревья переносятся в ast_ со сдвигом номеров
+void SyntaxAnalyzer::runParallel(bool recover, ThreadPool& pool) {
+    const size_t begin = stream_.randomAccess() ? stream_.position() : 0;
+    const size_t total = stream_.randomAccess() ? stream_.size() - std::min(begin, stream_.size()) : 0;
+    const size_t groupCount = std::min(pool.size() * 4, total / kMinGroupTokens);
+    if (pool.size() == 1 || groupCount < 2) {
+        run(recover);
+        return;
+    }
+
+    // Начала групп: первая граница объявления не раньше равной доли токенов
+    std::vector<size_t> starts = declarationStarts(stream_);
+    std::vector<size_t> splits{begin};
+    for (size_t g = 1; g < groupCount; ++g) {
+        auto it = std::lower_bound(starts.begin(), starts.end(), begin + total * g / groupCount);
+        if (it != starts.end() && *it > splits.back()) {
+            splits.push_back(*it);
+        }
+    }
+    splits.push_back(SIZE_MAX);
+    if (splits.size() < 3) {
+        run(recover);
+        return;
+    }
+
+    const size_t parts = splits.size() - 1;
+    std::vector<std::unique_ptr<SyntaxAnalyzer>> analyzers(parts);
+    for (size_t k = 0; k < parts; ++k) {
+        // Конструктор закрытый, поэтому не make_unique
+        analyzers[k].reset(new SyntaxAnalyzer(stream_, source_));
+        analyzers[k]->stream_.seek(splits[k]);
+        analyzers[k]->limit_ = splits[k + 1];
+        analyzers[k]->recover_ = recover;
+    }
+    pool.parallelFor(parts, [&](size_t k) {
+        SyntaxAnalyzer& part = *analyzers[k];
+        part.ast_.setRoot(part.parseProgram());
+    });
+
+    // Слияние в порядке исходника. Без восстановления разбор останавливается
+    // на первой ошибке, поэтому берётся ошибка самой ранней группы.
+    recover_ = recover;
+    diagnostics_.clear();
+    ast_.clear();
+    NodeId program = ast_.add(NodeKind::Program, analyzers.front()->ast_[0].offset);
+    ChildList statements(ast_, program);
+    for (const auto& analyzer : analyzers) {
+        SyntaxAnalyzer& part = *analyzer;
+        if (!part.diagnostics_.empty()) {
+            diagnostics_.insert(diagnostics_.end(), std::make_move_iterator(part.diagnostics_.begin()),
+                                std::make_move_iterator(part.diagnostics_.end()));
+            if (!recover) {
+                // Как после run(): корня нет, поток стоит на ошибочном токене
+                ast_.setRoot(kNoNode);
+                stream_.seek(part.stream_.position());
+                return;
+            }
+        }
+        NodeId base = ast_.append(part.ast_);
+        for (NodeId child = ast_[base + part.ast_.root()].firstChild; child != kNoNode;) {
+            NodeId next = ast_[child].nextSibling;
+            ast_[child].nextSibling = kNoNode;
+            statements.append(child);
+            child = next;
+        }
+    }
+    ast_.setRoot(program);
+
+    // Поток основного анализатора - там, где остановилась последняя группа:
+    // она дочитывает ввод до EndOfFile, как последовательный разбор
+    stream_.seek(analyzers.back()->stream_.position());
+}
+
+void SyntaxAnalyzer::analyzeParallel(ThreadPool& pool) {
+    runParallel(false, pool);
+    if (!diagnostics_.empty()) {
+        throw SyntaxError(diagnostics_.front());
+    }
+}
+
+bool SyntaxAnalyzer::analyzeAllParallel(ThreadPool& pool) {
+    runParallel(true, pool);
+    return diagnostics_.empty();
+}
@@ -0,0 +1,130 @@
+// ThreadPool.cpp
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Поток сейчас выполняет индексы задания какого-либо пула: вложенный
+// parallelFor из него идёт на этом же потоке, иначе он ждал бы освобождения
+// пула, который сам и занимает
+thread_local bool insideJob = false;
+
+// insideJob на время runIndices, в том числе при выходе по исключению
+struct JobScope {
+    JobScope() { insideJob = true; }
+    ~JobScope() { insideJob = false; }
+};
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Вызывающий поток тоже работает, поэтому фоновых на один меньше
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Разбирает индексы текущего задания, пока они не кончатся. Исключение из
+// задания не выходит за пределы потока: первое сохраняется для parallelFor,
+// и оставшиеся индексы больше не раздаются.
+void ThreadPool::runIndices() {
+    JobScope scope;
+    try {
+        while (true) {
+            size_t i = nextIndex_.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count_) {
+                break;
+            }
+            (*job_)(i);
+        }
+    } catch (...) {
+        nextIndex_.store(count_, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            ++activeWorkers_;
+        }
+        runIndices();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --activeWorkers_;
+        }
+        done_.notify_all();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (workers_.empty() || count == 1 || insideJob) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    // Задания разных потоков идут по очереди; вложенные сюда не доходят
+    static std::mutex submitMutex;
+    std::lock_guard<std::mutex> submit(submitMutex);
+    {
+        // Поля задания меняются, только когда ни один рабочий поток их не читает
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return activeWorkers_ == 0; });
+        job_ = &fn;
+        count_ = count;
+        nextIndex_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    runIndices();
+
+    // Ждём, пока рабочие потоки закончат взятые индексы: до этого fn и то,
+    // что она захватила, должны жить, даже если задание бросило исключение
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return activeWorkers_ == 0; });
+        job_ = nullptr;
+        std::swap(error, error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,105 @@
+// TokenBuffer.cpp
+#include "../include/TokenBuffer.h"
+
+#include <cstring>
+
+#include "../include/Lexer.h"
+
+// Лексит весь оставшийся ввод в компактный буфер
+TokenBuffer TokenBuffer::fromLexer(Lexer& lexer) {
+    TokenBuffer buffer(lexer.sourceBuffer());
+    // Грубая оценка: один токен на каждые ~4 байта исходника
+    buffer.reserve(lexer.sourceBuffer()->size() / 4 + 1);
+    while (true) {
+        Token tok = lexer.next();
+        buffer.push(tok);
+        if (tok.type == TokenType::EndOfFile) {
+            break;
+        }
+    }
+    return buffer;
+}
+
+void TokenBuffer::reserve(size_t count) {
+    kinds_.reserve(count);
+    offsets_.reserve(count);
+    lengths_.reserve(count);
+    symbols_.reserve(count);
+    payloads_.reserve(count);
+}
+
+// Значение строкового литерала начинается после открывающей кавычки
+static uint32_t valueShift(TokenType type) {
+    return type == TokenType::StringLiteral ? 1 : 0;
+}
+
+void TokenBuffer::push(const Token& tok) {
+    uint8_t kind = static_cast<uint8_t>(tok.type);
+    const char* base = source_->data();
+    const char* expected = base + tok.offset + valueShift(tok.type);
+    uint32_t payload = kNoPayload;
+    // Значение литерала лексер всегда берёт срезом исходника, поэтому у
+    // токена бывает либо число, либо раскодированная строка
+    if (hasLiteral(tok.type)) {
+        payload = static_cast<uint32_t>(literals_.size());
+        literals_.push_back(tok.type == TokenType::BooleanLiteral ? int64_t{tok.boolValue} : tok.intValue);
+    } else if (!tok.value.empty() && tok.value.data() != expected) {
+        // Значение, не совпадающее со срезом исходника, сохраняется отдельно
+        kind |= kDecodedFlag;
+        payload = static_cast<uint32_t>(decoded_.size());
+        decoded_.emplace_back(tok.value);
+    }
+    kinds_.push_back(kind);
+    offsets_.push_back(tok.offset);
+    lengths_.push_back(static_cast<uint32_t>(tok.value.size()));
+    symbols_.push_back(tok.symbol);
+    payloads_.push_back(payload);
+}
+
+std::string_view TokenBuffer::text(size_t i) const {
+    if (kinds_[i] & kDecodedFlag) {
+        return decoded_[payloads_[i]];
+    }
+    if (lengths_[i] == 0) {
+        return {};
+    }
+    return {source_->data() + offsets_[i] + valueShift(type(i)), lengths_[i]};
+}
+
+bool TokenBuffer::hasLiteral(TokenType type) {
+    return type == TokenType::IntegerLiteral || type == TokenType::FloatLiteral ||
+           type == TokenType::BooleanLiteral;
+}
+
+int64_t TokenBuffer::literalBits(size_t i) const {
+    if (payloads_[i] == kNoPayload || (kinds_[i] & kDecodedFlag)) {
+        return 0;
+    }
+    return literals_[payloads_[i]];
+}
+
+int64_t TokenBuffer::intValue(size_t i) const {
+    return literalBits(i);
+}
+
+double TokenBuffer::floatValue(size_t i) const {
+    int64_t bits = literalBits(i);
+    double value;
+    std::memcpy(&value, &bits, sizeof value);
+    return value;
+}
+
+bool TokenBuffer::boolValue(size_t i) const {
+    return literalBits(i) != 0;
+}
+
+Token TokenBuffer::at(size_t i) const {
+    Token tok(type(i), text(i), offsets_[i]);
+    tok.symbol = symbols_[i];
+    if (tok.type == TokenType::BooleanLiteral) {
+        tok.boolValue = boolValue(i);
+    } else if (hasLiteral(tok.type)) {
+        tok.intValue = literalBits(i);
+    }
+    return tok;
+}
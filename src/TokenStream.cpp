@@ -0,0 +1,66 @@
+// TokenStream.cpp
+#include "../include/TokenStream.h"
+
+#include <cassert>
+
+// Токен конца файла для чтения за пределами массива
+const Token& TokenStream::endOfFile() {
+    // Смещение за концом любого текста: позиция указывает на его конец
+    static const Token eof(TokenType::EndOfFile, "", UINT32_MAX);
+    return eof;
+}
+
+// Следующий токен из лексера или из компактного буфера
+Token TokenStream::pull() {
+    if (lexer_) {
+        return lexer_->next();
+    }
+    // Номер растёт и за концом, чтобы index_ - count_ был номером текущего
+    size_t i = index_++;
+    return i < buffer_->size() ? buffer_->at(i) : endOfFile();
+}
+
+// Просмотр вперёд без продвижения
+const Token& TokenStream::peek(size_t k) {
+    assert(k < kLookahead);
+    if (!usesRing()) {
+        return index_ + k < tokens_.size() ? tokens_[index_ + k] : endOfFile();
+    }
+    // Дочитываем недостающие токены
+    while (count_ <= k) {
+        ring_[(head_ + count_) & (kLookahead - 1)] = pull();
+        ++count_;
+    }
+    return ring_[(head_ + k) & (kLookahead - 1)];
+}
+
+// Возвращает текущий токен и продвигается вперёд
+Token TokenStream::next() {
+    Token tok = peek();
+    advance();
+    return tok;
+}
+
+// Переходит к следующему токену
+void TokenStream::advance() {
+    if (!usesRing()) {
+        if (index_ < tokens_.size()) {
+            ++index_;
+        }
+        return;
+    }
+    if (count_ == 0) {
+        pull();
+        return;
+    }
+    head_ = (head_ + 1) & (kLookahead - 1);
+    --count_;
+}
+
+// Переходит к i-му токену (только при произвольном доступе)
+void TokenStream::seek(size_t i) {
+    assert(randomAccess());
+    index_ = i;
+    head_ = 0;
+    count_ = 0;
+}
@@ -2,6 +2,7 @@
 #include <iostream>
 
 #include "../include/Lexer.h"
+#include "../include/RpnGenerator.h"
 #include "../include/Syntaxer.h"
 #include "RPN.h"
 
@@ -16,6 +17,8 @@ std::string tokenTypeToString(TokenType type) {
       return "Identifier";
     case TokenType::IntegerLiteral:
       return "IntegerLiteral";
+    case TokenType::FloatLiteral:
+      return "FloatLiteral";
     case TokenType::StringLiteral:
       return "StringLiteral";
     case TokenType::BooleanLiteral:
@@ -64,6 +67,26 @@ std::string tokenTypeToString(TokenType type) {
       return "KW_TRUE";
     case TokenType::KW_FALSE:
       return "KW_FALSE";
+    case TokenType::KW_UNDEFINED:
+      return "KW_UNDEFINED";
+    case TokenType::KW_NULL:
+      return "KW_NULL";
+    case TokenType::KW_ELIF:
+      return "KW_ELIF";
+    case TokenType::KW_SWITCH:
+      return "KW_SWITCH";
+    case TokenType::KW_BREAK:
+      return "KW_BREAK";
+    case TokenType::KW_CONTINUE:
+      return "KW_CONTINUE";
+    case TokenType::KW_GET:
+      return "KW_GET";
+    case TokenType::KW_POST:
+      return "KW_POST";
+    case TokenType::KW_PUT:
+      return "KW_PUT";
+    case TokenType::KW_DELETE:
+      return "KW_DELETE";
     case TokenType::OP_ASSIGN:
       return "OP_ASSIGN";
     case TokenType::OP_PLUS:
@@ -123,23 +146,51 @@ std::string tokenTypeToString(TokenType type) {
   }
 }
 
-int main() {
-    std::vector<Token> tokens = {
-            {TokenType::KW_FUNCTION, "function", 1, 1},
-            {TokenType::Identifier, "main", 1, 10},
-            {TokenType::LPAREN, "(", 1, 15},
-            {TokenType::RPAREN, ")", 1, 16},
-            {TokenType::LBRACE, "{", 1, 18},
-            {TokenType::KW_RETURN, "return", 2, 3},
-            {TokenType::IntegerLiteral, "42", 2, 10},
-            {TokenType::SEMICOLON, ";", 2, 12},
-            {TokenType::RBRACE, "}", 3, 1},
-            {TokenType::EndOfFile, "", 3, 2}
-    };
+int main(int argc, char* argv[]) {
+    // --run файл: исходник переводится в RPN за один проход и исполняется
+    if (argc > 2 && std::string(argv[1]) == "--run") {
+        try {
+            Lexer lexer(SourceBuffer::mapFile(argv[2]));
+            auto program = RpnGenerator(lexer).generate();
+            elangRPN::Context globals;
+            elangRPN::Interpreter interpreter(&globals);
+            interpreter.evaluateExpression(program.get(), &globals);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // С путём к файлу: исходник отображается в память, лексится без копирования
+    // и разбирается за один проход; выводятся все найденные ошибки
+    if (argc > 1) {
+        try {
+            Lexer lexer(SourceBuffer::mapFile(argv[1]));
+            SyntaxAnalyzer analyzer(lexer);
+            if (!analyzer.analyzeAll()) {
+                for (const Diagnostic& d : analyzer.diagnostics()) {
+                    std::cerr << argv[1] << ":" << d.line << ":" << d.column << ": " << d.message << "\n";
+                }
+                return 1;
+            }
+            std::cout << "Parsing completed successfully.\n";
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    Lexer demo("function main() {\n"
+               "  return 42;\n"
+               "}\n");
+    std::vector<Token> tokens = demo.tokenize();
 
     try {
-        SyntaxAnalyzer analyzer(tokens);
+        SyntaxAnalyzer analyzer(tokens, demo.sourceBuffer());
         analyzer.analyze();
+        std::cout << "Parsing completed successfully.\n";
     } catch (const SyntaxError& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -210,7 +261,8 @@ int main() {
   // for (const auto& token : tokens) {
   //   std::cout << "Token(Type: " << tokenTypeToString(token.type)
   //             << ", Value: \"" << token.value << "\""
-  //             << ", Line: " << token.line << ", Column: " << token.column
+  //             << ", Line: " << lexer.sourceBuffer()->position(token.offset).line
+  //             << ", Column: " << lexer.sourceBuffer()->position(token.offset).column
   //             << ")\n";
   // }
 
@@ -1,25 +1,257 @@
 #include "../include/trie.h"
 
-Trie::Trie() : root_(new Node()) {}
+#include <unistd.h>
 
-void Trie::AddString(std::string& str) {
-    Node* v = root_;
-    for (char c : str) {
-        if (!v->to[c]) {
-            v->to[c] = new Node();
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr char kImageMagic[8] = {'E', 'L', 'G', 'T', 'R', 'I', 'E', '\0'};
+
+// Заголовок образа; за ним массивы base и check по cells элементов
+struct ImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t cells;
+    uint64_t words;
+    uint64_t sourceHash;
+    uint64_t checksum;  // Trie::Hash по обоим массивам
+};
+static_assert(sizeof(ImageHeader) % alignof(int32_t) == 0);
+
+}  // namespace
+
+// Пустое дерево строится при первом запросе, до этого памяти не занимает
+Trie::Trie() : dirty_(true) {}
+
+Trie Trie::FromFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    Trie trie;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            trie.AddString(line);
         }
-        v = v->to[c];
     }
-    v->is_terminal = true;
+    trie.Build();
+    return trie;
 }
 
-bool Trie::Contains(std::string& str) {
-    Node* v = root_;
+void Trie::AddString(std::string_view str, uint32_t value) {
+    Unmap();
+    words_[std::string(str)] = value;
+    dirty_ = true;
+}
+
+bool Trie::Contains(std::string_view str) const {
+    Cells cells = View();
+    int32_t state = 0;
     for (char c : str) {
-        if (!v->to[c]) {
+        state = Next(cells, state, Code(c));
+        if (state < 0) {
             return false;
         }
-        v = v->to[c];
     }
-    return v->is_terminal;
+    return Next(cells, state, 0) >= 0;
+}
+
+Trie::Match Trie::LongestMatch(const char* p, const char* end) const {
+    Cells cells = View();
+    Match result;
+    int32_t state = 0;
+    for (const char* q = p; q < end; ++q) {
+        state = Next(cells, state, Code(*q));
+        if (state < 0) {
+            break;
+        }
+        int32_t leaf = Next(cells, state, 0);
+        if (leaf >= 0) {
+            result = {static_cast<size_t>(q - p + 1), static_cast<uint32_t>(-1 - cells.base[leaf])};
+        }
+    }
+    return result;
+}
+
+Trie::Cells Trie::View() const {
+    if (image_) {
+        auto header = reinterpret_cast<const ImageHeader*>(image_->data());
+        auto base = reinterpret_cast<const int32_t*>(image_->data() + sizeof(ImageHeader));
+        return {base, base + header->cells, header->cells};
+    }
+    if (dirty_) {
+        Build();
+    }
+    return {base_.data(), check_.data(), check_.size()};
+}
+
+void Trie::Build() const {
+    if (image_) {
+        return;
+    }
+    base_.assign(1, 0);
+    check_.assign(1, kRootCheck);
+    firstFree_ = 1;
+    if (!words_.empty()) {
+        BuildNode(0, 0, words_.begin(), words_.end());
+    }
+    dirty_ = false;
+}
+
+void Trie::BuildNode(int32_t state, size_t depth, WordIt first, WordIt last) const {
+    // Дети узла: слово, кончающееся на depth (код 0, в порядке сортировки
+    // оно первое), и группы слов с одинаковым символом на позиции depth
+    std::vector<int32_t> codes;
+    std::vector<WordIt> groups;
+    for (WordIt it = first; it != last; ++it) {
+        int32_t code = it->first.size() == depth ? 0 : Code(it->first[depth]);
+        if (codes.empty() || codes.back() != code) {
+            codes.push_back(code);
+            groups.push_back(it);
+        }
+    }
+    groups.push_back(last);
+
+    int32_t base = FindBase(codes);
+    base_[state] = base;
+    // Сначала занимаем все ячейки детей, затем спускаемся в них
+    for (int32_t code : codes) {
+        check_[base + code] = state;
+    }
+    while (static_cast<size_t>(firstFree_) < check_.size() && check_[firstFree_] != kFree) {
+        ++firstFree_;
+    }
+
+    for (size_t i = 0; i < codes.size(); ++i) {
+        int32_t child = base + codes[i];
+        if (codes[i] == 0) {
+            // Лист: база хранит значение слова
+            base_[child] = -1 - static_cast<int32_t>(groups[i]->second);
+        } else {
+            BuildNode(child, depth + 1, groups[i], groups[i + 1]);
+        }
+    }
+}
+
+int32_t Trie::FindBase(const std::vector<int32_t>& codes) const {
+    for (int32_t base = std::max(1, firstFree_ - codes.front());; ++base) {
+        Reserve(static_cast<size_t>(base + codes.back()) + 1);
+        bool fits = std::all_of(codes.begin(), codes.end(),
+                                [&](int32_t code) { return check_[base + code] == kFree; });
+        if (fits) {
+            return base;
+        }
+    }
+}
+
+void Trie::Reserve(size_t size) const {
+    if (check_.size() < size) {
+        base_.resize(size, 0);
+        check_.resize(size, kFree);
+    }
+}
+
+uint64_t Trie::Hash(std::string_view bytes, uint64_t hash) {
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+void Trie::Save(const std::string& path, uint64_t sourceHash) const {
+    Cells cells = View();
+    std::string_view base(reinterpret_cast<const char*>(cells.base), cells.size * sizeof(int32_t));
+    std::string_view check(reinterpret_cast<const char*>(cells.check), cells.size * sizeof(int32_t));
+
+    ImageHeader header{};
+    std::memcpy(header.magic, kImageMagic, sizeof header.magic);
+    header.version = kImageVersion;
+    header.cells = static_cast<uint32_t>(cells.size);
+    header.words = Size();
+    header.sourceHash = sourceHash;
+    header.checksum = Hash(check, Hash(base));
+
+    // Пишем во временный файл и переименовываем: параллельно запущенные
+    // процессы видят либо старый образ, либо новый целиком
+    std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        throw std::runtime_error("Cannot create " + tmp + ": " + std::strerror(errno));
+    }
+    bool ok = std::fwrite(&header, sizeof header, 1, f) == 1 &&
+              std::fwrite(base.data(), 1, base.size(), f) == base.size() &&
+              std::fwrite(check.data(), 1, check.size(), f) == check.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+std::optional<Trie> Trie::Load(const std::string& path, uint64_t sourceHash) {
+    std::shared_ptr<const SourceBuffer> image;
+    try {
+        image = SourceBuffer::mapFile(path);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+    if (image->size() < sizeof(ImageHeader)) {
+        return std::nullopt;
+    }
+    ImageHeader header;
+    std::memcpy(&header, image->data(), sizeof header);
+    size_t arrayBytes = static_cast<size_t>(header.cells) * sizeof(int32_t);
+    if (std::memcmp(header.magic, kImageMagic, sizeof header.magic) != 0 ||
+        header.version != kImageVersion || header.sourceHash != sourceHash || header.cells == 0 ||
+        image->size() != sizeof header + 2 * arrayBytes) {
+        return std::nullopt;
+    }
+    std::string_view arrays(image->data() + sizeof header, 2 * arrayBytes);
+    if (Hash(arrays.substr(arrayBytes), Hash(arrays.substr(0, arrayBytes))) != header.checksum) {
+        return std::nullopt;
+    }
+
+    Trie trie;
+    trie.dirty_ = false;
+    trie.image_ = std::move(image);
+    trie.imageWords_ = header.words;
+    return trie;
+}
+
+void Trie::Unmap() {
+    if (!image_) {
+        return;
+    }
+    Cells cells = View();
+    std::string prefix;
+    CollectWords(cells, 0, prefix);
+    image_.reset();
+    dirty_ = true;
+}
+
+// Обход в глубину: все слова поддерева state с данным префиксом
+void Trie::CollectWords(const Cells& cells, int32_t state, std::string& prefix) {
+    for (int32_t code = 0; code <= 256; ++code) {
+        int32_t child = Next(cells, state, code);
+        if (child < 0) {
+            continue;
+        }
+        if (code == 0) {
+            words_[prefix] = static_cast<uint32_t>(-1 - cells.base[child]);
+        } else {
+            prefix.push_back(static_cast<char>(code - 1));
+            CollectWords(cells, child, prefix);
+            prefix.pop_back();
+        }
+    }
 }
@@ -0,0 +1,146 @@
+// document_test.cpp
+// Document после каждой случайной правки сверяется с разбором всего текста
+// заново: text(), ast().dump() и diagnostics() должны совпадать с
+// analyzeAll() на том же тексте. Правки вставляют скобки, кавычки, начала
+// комментариев и ключевые слова объявлений, поэтому участок разбора
+// расширяется на соседние куски; крупные правки набирают мусорные узлы и
+// имена до пересборки дерева (compact) и таблицы имён (compactSymbols).
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Document.h"
+
+namespace {
+
+const char* const kDeclarations[] = {
+    "function f(a: Int, b: Int): Int {\n  let v = a + b\n  print(v);\n}\n",
+    "let x = (1 + 2) * 3\n",
+    "var s = \"text\"\n",
+    "// comment\nlet y = x != false\n",
+    "GET /items {\n  respond(200, true, \"ok\");\n}\n",
+    "/* block\n   comment */\n",
+};
+
+// Обрывки, которые сдвигают границы кусков или ломают разбор
+const char* const kFragments[] = {
+    "{", "}", "(", ")", "\"", "/*", "*/", "//", "\n", ";", " ",
+    "function ", "let ", "var ", "GET ", "x", "= 1", "f(2)", "let z = 5\n",
+};
+
+std::string declarations(std::mt19937& rng, size_t count, size_t& nextName) {
+  std::string out;
+  for (size_t i = 0; i < count; ++i) {
+    out += kDeclarations[rng() % std::size(kDeclarations)];
+    // Свежее имя в каждом объявлении: таблица имён растёт
+    out += "let n" + std::to_string(nextName++) + " = 1\n";
+  }
+  return out;
+}
+
+std::string describe(const std::vector<Diagnostic>& diagnostics) {
+  std::string out;
+  for (const Diagnostic& d : diagnostics) {
+    out += std::to_string(d.offset) + ':' + std::to_string(d.line) + ':' +
+           std::to_string(d.column) + ' ' + d.message + '\n';
+  }
+  return out;
+}
+
+// Номера имён узлов под id указывают в таблицу документа на их же текст
+bool symbolsMatch(const Document& document, NodeId id) {
+  const AstNode& node = document.ast()[id];
+  if (node.symbol != kNoSymbol && document.symbols().name(node.symbol) != node.text) {
+    return false;
+  }
+  for (NodeId child = node.firstChild; child != kNoNode;
+       child = document.ast()[child].nextSibling) {
+    if (!symbolsMatch(document, child)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Пусто, если документ совпадает с разбором text заново, иначе - что не так
+const char* compare(const Document& document, const std::string& text) {
+  if (document.text() != text) {
+    return "text() differs";
+  }
+  Lexer lexer(SourceBuffer::fromString(text));
+  std::vector<Token> tokens = lexer.tokenize();
+  SyntaxAnalyzer parser(tokens, lexer.sourceBuffer());
+  parser.analyzeAll();
+  if (document.ast().dump() != parser.ast().dump()) {
+    return "ast().dump() differs";
+  }
+  if (describe(document.diagnostics()) != describe(parser.diagnostics())) {
+    return "diagnostics() differ";
+  }
+  if (document.ast().root() != kNoNode && !symbolsMatch(document, document.ast().root())) {
+    return "a node symbol names another identifier";
+  }
+  return "";
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  bool compacted = false;
+  bool symbolsCompacted = false;
+  for (unsigned seed = 1; seed <= 6; ++seed) {
+    std::mt19937 rng(seed);
+    size_t nextName = 0;
+    std::string text = declarations(rng, 200, nextName);
+    Document document(text);
+
+    for (int step = 0; step < 60; ++step) {
+      const size_t nodes = document.ast().size();
+      const size_t names = document.symbols().size();
+      std::string inserted;
+      size_t offset;
+      size_t length;
+      if (step % 15 == 14) {
+        // Крупная правка: новые объявления вместо половины текста
+        offset = text.size() / 4;
+        length = text.size() / 2;
+        inserted = declarations(rng, 8000, nextName);
+      } else if (step % 15 == 0) {
+        // Возврат к небольшому документу: живых узлов и имён становится мало
+        offset = 0;
+        length = text.size();
+        inserted = declarations(rng, 100, nextName);
+      } else {
+        offset = rng() % (text.size() + 1);
+        length = std::min<size_t>(rng() % 12, text.size() - offset);
+        for (size_t k = rng() % 3; k > 0; --k) {
+          inserted += kFragments[rng() % std::size(kFragments)];
+        }
+      }
+      document.edit({offset, length, inserted});
+      text.replace(offset, length, inserted);
+      compacted |= document.ast().size() < nodes;
+      symbolsCompacted |= document.symbols().size() < names;
+
+      const char* error = compare(document, text);
+      if (*error != '\0') {
+        ++failures;
+        std::fprintf(stderr, "FAIL seed %u, edit %d (offset %zu, length %zu): %s\n", seed, step,
+                     offset, length, error);
+        break;
+      }
+    }
+  }
+  // Иначе тест не проверял бы пересборку
+  if (!compacted || !symbolsCompacted) {
+    ++failures;
+    std::fprintf(stderr, "FAIL edits never triggered compact (%d) or compactSymbols (%d)\n",
+                 compacted, symbolsCompacted);
+  }
+  std::fprintf(stderr, "%d failed\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// lexer_parallel_test.cpp
+// tokenizeParallel() сверяется с tokenize() токен в токен на всех бэкендах.
+// Входы больше минимального куска параллельной токенизации, и строки с
+// escape-последовательностями и переводами строк, комментарии обоих видов и
+// незакрытые литералы попадают на границы кусков.
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Lexer.h"
+
+namespace {
+
+// Случайный текст на языке примерно из size байт
+std::string corpus(size_t size, unsigned seed) {
+  static const char* const kPieces[] = {
+      "function f(a, b) {\n  return a + b * 2;\n}\n",
+      "let x = 42;\n",
+      "var y = 3.25e2;\n",
+      "if (x >= 10 && y != 0) { x = x - 1; } else { y = !y; }\n",
+      "while (i < 100) { i = i + 1; }\n",
+      "GET /users/:id {\n  return true;\n}\n",
+      "let s = \"plain\";\n",
+      "let e = \"esc \\\" quote \\\\ slash \\n newline\";\n",
+      "let m = \"multi\nline\nstring\";\n",
+      "// line comment with \"quote\" and /* inside\n",
+      "/* block comment\n   with // and \" inside\n   ** stars */\n",
+      "x = a / b / c;\n",
+      "let list = [1, 2, 3];\n",
+      "let obj = {a: 1, b: \"two\"};\n",
+      "print(x, y);\n",
+  };
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<size_t> pick(0, std::size(kPieces) - 1);
+  std::string text;
+  while (text.size() < size) {
+    text += kPieces[pick(rng)];
+  }
+  return text;
+}
+
+// Строка или комментарий длиннее куска: внутри неё окажется граница
+std::string longLiteral(size_t size) {
+  std::string text = "let before = 1;\n\"";
+  for (size_t i = 0; text.size() < size; ++i) {
+    text += i % 3 == 0 ? "esc \\\" \\\\ " : "text\n";
+  }
+  text += "\";\n/*";
+  for (size_t i = 0; text.size() < 2 * size; ++i) {
+    text += i % 2 == 0 ? "comment * / \" //\n" : "more\n";
+  }
+  text += "*/\nlet after = 2;\n";
+  return text;
+}
+
+bool sameToken(const Token& a, const Token& b) {
+  if (a.type != b.type || a.value != b.value || a.offset != b.offset ||
+      a.symbol != b.symbol) {
+    return false;
+  }
+  switch (a.type) {
+    case TokenType::IntegerLiteral:
+      return a.intValue == b.intValue;
+    case TokenType::FloatLiteral:
+      return a.floatValue == b.floatValue;
+    case TokenType::BooleanLiteral:
+      return a.boolValue == b.boolValue;
+    default:
+      return true;
+  }
+}
+
+// Число расхождений tokenizeParallel() с tokenize() на text
+int check(const char* name, const std::string& text, LexerBackend backend,
+          ThreadPool& pool) {
+  auto source = SourceBuffer::fromString(text);
+  SymbolTable sequentialSymbols;
+  SymbolTable parallelSymbols;
+  Lexer sequential(source, backend, sequentialSymbols);
+  Lexer parallel(source, backend, parallelSymbols);
+  std::vector<Token> expected = sequential.tokenize();
+  std::vector<Token> actual = parallel.tokenizeParallel(pool);
+
+  size_t common = std::min(expected.size(), actual.size());
+  for (size_t i = 0; i < common; ++i) {
+    if (!sameToken(expected[i], actual[i])) {
+      std::fprintf(stderr, "FAIL %s (backend %d): token %zu at offset %u differs\n", name,
+                   static_cast<int>(backend), i, expected[i].offset);
+      return 1;
+    }
+  }
+  if (expected.size() != actual.size()) {
+    std::fprintf(stderr, "FAIL %s (backend %d): %zu tokens, expected %zu\n", name,
+                 static_cast<int>(backend), actual.size(), expected.size());
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  // 12 минимальных кусков по 256 КиБ: пул из 4 потоков (до 16 кусков) режет
+  // вход на 12
+  constexpr size_t kSize = 3 * 1024 * 1024;
+  ThreadPool pool(4);
+
+  std::string mixed = corpus(kSize, 1);
+  std::string openString = corpus(kSize, 2);
+  openString.insert(openString.size() * 2 / 5, "\"unterminated \\\" string\n");
+  std::string openComment = corpus(kSize, 3);
+  openComment.insert(openComment.size() * 3 / 5, "/* unterminated comment\n");
+  std::string trailingSlash = corpus(kSize, 4) + "x = 1 /";
+  std::string longLiterals = longLiteral(700 * 1024);
+
+  const struct {
+    const char* name;
+    const std::string& text;
+  } inputs[] = {
+      {"mixed", mixed},
+      {"unterminated string", openString},
+      {"unterminated comment", openComment},
+      {"trailing slash", trailingSlash},
+      {"literals longer than a chunk", longLiterals},
+  };
+
+  int failures = 0;
+  int runs = 0;
+  for (const auto& input : inputs) {
+    for (LexerBackend backend :
+         {LexerBackend::Switch, LexerBackend::Table, LexerBackend::Trie}) {
+      failures += check(input.name, input.text, backend, pool);
+      ++runs;
+    }
+  }
+  std::fprintf(stderr, "%d runs, %d failed\n", runs, failures);
+  return failures == 0 ? 0 : 1;
+}
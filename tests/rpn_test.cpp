@@ -0,0 +1,140 @@
+// rpn_test.cpp
+// Программы на языке переводятся RpnGenerator и исполняются
+// elangRPN::Interpreter; вывод print сравнивается с ожидаемым.
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "Lexer.h"
+#include "RpnGenerator.h"
+
+namespace {
+
+struct Case {
+  const char* name;
+  const char* source;
+  const char* expected;  // вывод print, по значению в строке
+};
+
+const Case kCases[] = {
+    {"int literal above INT32_MAX",
+     "let big = 3000000000;\n"
+     "print(big);\n"
+     "print(big * 4 + 1);\n"
+     "print(9223372036854775807);\n",
+     "3000000000\n12000000001\n9223372036854775807\n"},
+    {"int arithmetic wraps around on overflow",
+     "let max = 9223372036854775807;\n"
+     "let min = -max - 1;\n"
+     "print(max + 1);\n"
+     "print(min - 1);\n"
+     "print(max * 2);\n"
+     "print(-min);\n",
+     "-9223372036854775808\n9223372036854775807\n-2\n-9223372036854775808\n"},
+    {"INT64_MIN divided by -1",
+     "let min = -9223372036854775807 - 1;\n"
+     "print(min / -1);\n"
+     "print(min % -1);\n"
+     "print(7 / -1);\n"
+     "print(min / 0);\n",
+     "-9223372036854775808\n0\n-7\nundefined\n"},
+    {"float literal keeps double range",
+     "print(0.5);\n"
+     "print(1e300);\n",
+     "0.5\n1e+300\n"},
+    {"float arithmetic and comparisons",
+     "let a = 1.5;\n"
+     "print(a + 1);\n"
+     "print(2 * a);\n"
+     "print(a - 0.25);\n"
+     "print(a / 2);\n"
+     "print(5.5 % 2);\n"
+     "print(-a);\n"
+     "print(a < 2);\n"
+     "print(2 >= a);\n"
+     "print(a == 1.5);\n"
+     "print(1.0 == 1);\n"
+     "print(!a);\n"
+     "print(1 / 0.0);\n",
+     "2.5\n3\n1.25\n0.75\n1.5\n-1.5\n1\n1\n1\n1\n0\ninf\n"},
+    {"read before the first local assignment sees the global",
+     "let x = 1;\n"
+     "function f() { x = x + 1; return x; }\n"
+     "print(f());\n"
+     "print(f());\n"
+     "print(x);\n",
+     "2\n2\n1\n"},
+    {"read before the first local assignment sees the enclosing function",
+     "function g() {\n"
+     "  let y = 10;\n"
+     "  function h() { y = y + 5; return y; }\n"
+     "  print(h());\n"
+     "  print(y);\n"
+     "  return 0;\n"
+     "}\n"
+     "g();\n",
+     "15\n10\n"},
+    {"local shadows the global from its first assignment on",
+     "let x = 1;\n"
+     "function loop() {\n"
+     "  let i = 0;\n"
+     "  while (i < 3) { print(x); x = 100 + i; i = i + 1; }\n"
+     "  return x;\n"
+     "}\n"
+     "print(loop());\n"
+     "print(x);\n",
+     "1\n100\n101\n102\n1\n"},
+    {"calls in a loop pop all their arguments",
+     "let g = 5;\n"
+     "function h(a) { return a; }\n"
+     "let i = 0;\n"
+     "while (i < 20000) { g(1, 2); h(1, 2, 3); i = i + 1; }\n"
+     "print(i);\n",
+     "20000\n"},
+    {"missing arguments are undefined, surplus ones are dropped",
+     "function k(a, b, c) { return c; }\n"
+     "function h(a) { return a; }\n"
+     "print(k(1));\n"
+     "print(h(7, 8, 9));\n"
+     "print(g(1, 2));\n",
+     "undefined\n7\nundefined\n"},
+    {"print prints every argument and gives undefined",
+     "let r = print(1, 2 + 3);\n"
+     "print(r);\n",
+     "1\n5\nundefined\n"},
+};
+
+// Вывод print при исполнении source
+std::string run(const char* source) {
+  std::ostringstream out;
+  std::streambuf* saved = std::cout.rdbuf(out.rdbuf());
+  try {
+    Lexer lexer{std::string(source)};
+    auto program = RpnGenerator(lexer).generate();
+    elangRPN::Context globals;
+    elangRPN::Interpreter interpreter(&globals);
+    interpreter.evaluateExpression(program.get(), &globals);
+  } catch (const std::exception& e) {
+    out << "exception: " << e.what() << '\n';
+  }
+  std::cout.rdbuf(saved);
+  return out.str();
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  for (const Case& c : kCases) {
+    std::string actual = run(c.source);
+    if (actual != c.expected) {
+      ++failures;
+      std::fprintf(stderr, "FAIL %s\n--- expected\n%s--- actual\n%s", c.name, c.expected,
+                   actual.c_str());
+    }
+  }
+  std::fprintf(stderr, "%zu cases, %d failed\n", std::size(kCases), failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+// syntaxer_parallel_test.cpp
+// Параллельный разбор сверяется с последовательным: дерево (Ast::dump) и
+// ошибки analyzeAllParallel() - с analyzeAll(), а при ошибке
+// analyzeParallel() оставляет то же состояние, что analyze(): корня нет,
+// поток стоит на ошибочном токене.
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Lexer.h"
+#include "Syntaxer.h"
+
+namespace {
+
+// Объявления верхнего уровня, часть с ошибками; declarations штук
+std::string corpus(size_t declarations, unsigned seed, bool withErrors) {
+  std::mt19937 rng(seed);
+  std::string out;
+  for (size_t n = 0; n < declarations; ++n) {
+    std::string id = std::to_string(n);
+    switch (rng() % (withErrors ? 9 : 5)) {
+      case 0:
+        out += "function f" + id + "(a: Int, b: Float): Int {\n"
+               "  let v = a + b * " + id + "\n"
+               "  print(v, \"f" + id + "\");\n"
+               "  a + v;\n}\n";
+        break;
+      case 1:
+        out += "let c" + id + " = (" + id + " + 1) * 2\n";
+        break;
+      case 2:
+        out += "var s" + id + " = \"text " + id + "\"\n";
+        break;
+      case 3:
+        out += "// комментарий " + id + "\nlet b" + id + " = c1 != false && !x\n";
+        break;
+      case 4:
+        out += "function g" + id + "() {\n  h(1, 2).field;\n}\n";
+        break;
+      // Ошибки: в начале, в середине и в конце объявления
+      case 5:
+        out += "let = " + id + "\n";
+        break;
+      case 6:
+        out += "let e" + id + " = (1 + ;\n";
+        break;
+      case 7:
+        out += "function (a: Int) {\n  a;\n}\n";
+        break;
+      default:
+        out += "}\nlet d" + id + " = 1\n";
+        break;
+    }
+  }
+  return out;
+}
+
+std::string describe(const std::vector<Diagnostic>& diagnostics) {
+  std::string out;
+  for (const Diagnostic& d : diagnostics) {
+    out += std::to_string(d.offset) + ':' + std::to_string(d.line) + ':' +
+           std::to_string(d.column) + ' ' + d.message + '\n';
+  }
+  return out;
+}
+
+int fail(const char* name, const char* what) {
+  std::fprintf(stderr, "FAIL %s: %s\n", name, what);
+  return 1;
+}
+
+// Число расхождений параллельного разбора text с последовательным
+int check(const char* name, const std::string& text, ThreadPool& pool) {
+  Lexer lexer(SourceBuffer::fromString(text));
+  std::vector<Token> tokens = lexer.tokenize();
+  const auto& source = lexer.sourceBuffer();
+
+  SyntaxAnalyzer sequential(tokens, source);
+  SyntaxAnalyzer parallel(tokens, source);
+  bool sequentialOk = sequential.analyzeAll();
+  bool parallelOk = parallel.analyzeAllParallel(pool);
+  if (sequentialOk != parallelOk) {
+    return fail(name, "analyzeAllParallel() result differs");
+  }
+  if (parallel.ast().dump() != sequential.ast().dump()) {
+    return fail(name, "analyzeAllParallel() tree differs");
+  }
+  if (describe(parallel.diagnostics()) != describe(sequential.diagnostics())) {
+    return fail(name, "analyzeAllParallel() diagnostics differ");
+  }
+
+  SyntaxAnalyzer first(tokens, source);
+  SyntaxAnalyzer firstParallel(tokens, source);
+  std::string error;
+  std::string parallelError;
+  try {
+    first.analyze();
+  } catch (const SyntaxError& e) {
+    error = e.what();
+  }
+  try {
+    firstParallel.analyzeParallel(pool);
+  } catch (const SyntaxError& e) {
+    parallelError = e.what();
+  }
+  if (parallelError != error) {
+    return fail(name, "analyzeParallel() error differs");
+  }
+  if (firstParallel.position() != first.position()) {
+    return fail(name, "analyzeParallel() stops at another token");
+  }
+  if (error.empty()) {
+    if (firstParallel.ast().dump() != first.ast().dump()) {
+      return fail(name, "analyzeParallel() tree differs");
+    }
+  } else {
+    if (firstParallel.ast().root() != kNoNode) {
+      return fail(name, "analyzeParallel() keeps a root after an error");
+    }
+    if (tokens[firstParallel.position()].offset != first.diagnostics().front().offset) {
+      return fail(name, "analyzeParallel() does not stop at the failing token");
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  // Десятки тысяч токенов на группу: пул из 4 потоков делит разбор на группы
+  constexpr size_t kDeclarations = 40000;
+  ThreadPool pool(4);
+
+  const struct {
+    const char* name;
+    std::string text;
+  } inputs[] = {
+      {"no errors", corpus(kDeclarations, 1, false)},
+      {"errors", corpus(kDeclarations, 2, true)},
+      {"errors, other seed", corpus(kDeclarations, 3, true)},
+      {"error in the last group", corpus(kDeclarations, 4, false) + "let = 1\n"},
+  };
+
+  int failures = 0;
+  for (const auto& input : inputs) {
+    failures += check(input.name, input.text, pool);
+  }
+  std::fprintf(stderr, "%zu inputs, %d failed\n", std::size(inputs), failures);
+  return failures == 0 ? 0 : 1;
+}